@@ -0,0 +1,355 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+#include "Matcher.h"
+
+namespace shl {
+
+	/*
+	 * Describes the niches of a type: values a real value never takes, which `adt` can use as tags
+	 *	An `adt` whose only non-empty alternative has a niche for each of the other (empty) alternatives stores nothing but that
+	 *	alternative, so `option<T*>` is pointer-sized. Only trivially copyable types can have niches
+	 *
+	 *	`count` - The number of niches
+	 *	`value(i)` - The i'th niche
+	 *	`index(v)` - Which niche `v` is, or `count` if it's a real value
+	 *
+	 *	enum class Color : uint8_t { Red, Green, Blue };
+	 *	template<> struct niche_traits<Color> : spare_values<Color, Color(3), Color(255)> {};
+	 */
+	template<class T, class = void>
+	struct niche_traits {
+		static constexpr size_t count = 0;
+	};
+
+	// Pointers to objects with an alignment above 1 never hold the misaligned addresses 1 .. alignof(T) - 1 (null is a real pointer value)
+	template<class T>
+	struct niche_traits<T*, std::enable_if_t<std::is_object<T>::value>> {
+		static constexpr size_t count = alignof(T) - 1;
+
+		static T* value(size_t i) { return reinterpret_cast<T*>(static_cast<std::uintptr_t>(i + 1)); }
+
+		static size_t index(T* v) {
+			auto address = reinterpret_cast<std::uintptr_t>(v);
+			return (address != 0 && address < alignof(T)) ? size_t(address - 1) : count;
+		}
+	};
+
+	// Niches for an enum (with a fixed underlying type) that never uses the values First to Last
+	template<class E, E First, E Last>
+	struct spare_values {
+		private:
+			using underlying = std::underlying_type_t<E>;
+
+		public:
+			static constexpr size_t count = size_t(underlying(Last) - underlying(First)) + 1;
+
+			static constexpr E value(size_t i) { return static_cast<E>(underlying(First) + i); }
+
+			static constexpr size_t index(E v) {
+				return (underlying(v) >= underlying(First) && underlying(v) <= underlying(Last)) ? size_t(underlying(v) - underlying(First)) : count;
+			}
+	};
+
+
+	// Empty alternative for option-like types
+	struct none_t {
+		constexpr bool operator==(none_t) const { return true; }
+		constexpr bool operator!=(none_t) const { return false; }
+	};
+
+	inline constexpr none_t none{};
+
+
+	namespace impl {
+		template<size_t I, class... Alts>
+		using __Alt = std::tuple_element_t<I, std::tuple<Alts...>>;
+
+		/*
+		 * Layouts for `adt`, each storing the active alternative and answering `index` and `value<I>`
+		 *	Empty alternatives aren't stored by the niche and tag-only layouts, `value<I>` produces a fresh one instead
+		 */
+
+		// Niche layout: only the payload alternative P is stored, the empty alternatives (in order) are its niches
+		template<size_t P, class... Alts>
+		class __NicheStorage {
+			private:
+				using payload = __Alt<P, Alts...>;
+				using niches = niche_traits<payload>;
+
+				payload val;
+
+			protected:
+				template<size_t I, class... Args>
+				void construct(Args&&... args) {
+					if constexpr (I == P)
+						val = payload(std::forward<Args>(args)...);
+					else
+						val = niches::value(I < P ? I : I - 1);
+				}
+
+			public:
+				size_t index() const {
+					auto niche = niches::index(val);
+					return niche == niches::count ? P : niche < P ? niche : niche + 1;
+				}
+
+				template<size_t I>
+				decltype(auto) value() & {
+					if constexpr (I == P) return (val);
+					else return __Alt<I, Alts...>{};
+				}
+
+				template<size_t I>
+				decltype(auto) value() const& {
+					if constexpr (I == P) return (val);
+					else return __Alt<I, Alts...>{};
+				}
+
+				template<size_t I>
+				decltype(auto) value() && {
+					if constexpr (I == P) return std::move(val);
+					else return __Alt<I, Alts...>{};
+				}
+		};
+
+		// Tag-only layout: every alternative is empty, so the tag is all there is
+		template<class... Alts>
+		class __TagOnlyStorage {
+			private:
+				__TagFor<sizeof...(Alts)> tag = 0;
+
+			protected:
+				template<size_t I, class... Args>
+				void construct(Args&&...) {
+					tag = I;
+				}
+
+			public:
+				size_t index() const { return tag; }
+
+				template<size_t I>
+				__Alt<I, Alts...> value() const { return {}; }
+		};
+
+		// Tagged layout: a buffer fitting every alternative and the smallest tag that fits (one past the end is "valueless")
+		template<class... Alts>
+		class __TaggedBase {
+			protected:
+				using tag_type = __TagFor<sizeof...(Alts) + 1>;
+				static constexpr tag_type valueless = sizeof...(Alts);
+
+				alignas(Alts...) unsigned char buf[std::max({ sizeof(Alts)... })];
+				tag_type tag = valueless;
+
+				// Call `f(std::integral_constant<size_t, I>)` with the active alternative's index
+				template<class F>
+				void visit(F&& f) const {
+					visit(std::forward<F>(f), std::index_sequence_for<Alts...>{});
+				}
+
+				template<class F, size_t... Is>
+				void visit(F&& f, std::index_sequence<Is...>) const {
+					((tag == Is ? f(std::integral_constant<size_t, Is>{}) : void()), ...);
+				}
+
+				void destroy() {
+					visit([this](auto i) {
+						using alt = __Alt<decltype(i)::value, Alts...>;
+						value<decltype(i)::value>().~alt();
+					});
+
+					tag = valueless;
+				}
+
+				template<size_t I, class... Args>
+				void construct(Args&&... args) {
+					destroy();
+					::new (static_cast<void*>(buf)) __Alt<I, Alts...>(std::forward<Args>(args)...);
+					tag = I;
+				}
+
+			public:
+				size_t index() const { return tag; }
+
+				template<size_t I>
+				__Alt<I, Alts...>& value() & { return *std::launder(reinterpret_cast<__Alt<I, Alts...>*>(buf)); }
+
+				template<size_t I>
+				const __Alt<I, Alts...>& value() const& { return *std::launder(reinterpret_cast<const __Alt<I, Alts...>*>(buf)); }
+
+				template<size_t I>
+				__Alt<I, Alts...>&& value() && { return std::move(value<I>()); }
+		};
+
+		// Trivially copyable alternatives keep the layout trivially copyable
+		template<bool trivial, class... Alts>
+		class __TaggedStorage : public __TaggedBase<Alts...> {};
+
+		template<class... Alts>
+		class __TaggedStorage<false, Alts...> : public __TaggedBase<Alts...> {
+			private:
+				using base = __TaggedBase<Alts...>;
+
+			public:
+				__TaggedStorage() = default;
+
+				__TaggedStorage(const __TaggedStorage& other) {
+					other.visit([&](auto i) { this->template construct<decltype(i)::value>(other.template value<decltype(i)::value>()); });
+				}
+
+				__TaggedStorage(__TaggedStorage&& other) noexcept((... && std::is_nothrow_move_constructible<Alts>::value)) {
+					other.visit([&](auto i) { this->template construct<decltype(i)::value>(std::move(other).template value<decltype(i)::value>()); });
+				}
+
+				__TaggedStorage& operator=(const __TaggedStorage& other) {
+					if (this->tag == other.tag)
+						other.visit([&](auto i) { this->template value<decltype(i)::value>() = other.template value<decltype(i)::value>(); });
+					else if (this != &other)
+						__TaggedStorage{ other }.swap_into(*this);
+
+					return *this;
+				}
+
+				__TaggedStorage& operator=(__TaggedStorage&& other) noexcept((... && (std::is_nothrow_move_constructible<Alts>::value && std::is_nothrow_move_assignable<Alts>::value))) {
+					if (this->tag == other.tag)
+						other.visit([&](auto i) { this->template value<decltype(i)::value>() = std::move(other).template value<decltype(i)::value>(); });
+					else
+						other.visit([&](auto i) { this->template construct<decltype(i)::value>(std::move(other).template value<decltype(i)::value>()); });
+
+					return *this;
+				}
+
+				~__TaggedStorage() { this->destroy(); }
+
+			private:
+				// Move a copy into `target` (the copy is made first, so a throwing copy leaves `target` untouched)
+				void swap_into(__TaggedStorage& target) {
+					this->visit([&](auto i) { target.template construct<decltype(i)::value>(std::move(*this).template value<decltype(i)::value>()); });
+				}
+		};
+
+		// Deletes the copy operations of an adt whose alternatives can't all be copied
+		template<bool copyable>
+		struct __CopyGuard {};
+
+		template<>
+		struct __CopyGuard<false> {
+			__CopyGuard() = default;
+			__CopyGuard(const __CopyGuard&) = delete;
+			__CopyGuard(__CopyGuard&&) = default;
+			__CopyGuard& operator=(const __CopyGuard&) = delete;
+			__CopyGuard& operator=(__CopyGuard&&) = default;
+		};
+
+		// Pick the smallest layout for the alternatives
+		template<class... Alts>
+		struct __ADTLayout {
+			private:
+				static constexpr size_t empties = (size_t{ 0 } + ... + std::is_empty<Alts>::value);
+				static constexpr size_t payload = __IndexOf<bool, false, 0, std::is_empty<Alts>::value...>::value;
+
+				template<size_t P, bool = (empties + 1 == sizeof...(Alts))>
+				struct niche_fits : bool_t<std::is_trivially_copyable<__Alt<P, Alts...>>::value && (niche_traits<__Alt<P, Alts...>>::count >= empties)> {};
+
+				template<size_t P>
+				struct niche_fits<P, false> : std::false_type {};
+
+				static constexpr bool trivial = (... && (std::is_trivially_copyable<Alts>::value && std::is_trivially_destructible<Alts>::value));
+
+			public:
+				using type = std::conditional_t<empties == sizeof...(Alts), __TagOnlyStorage<Alts...>,
+					typename std::conditional_t<niche_fits<(empties + 1 == sizeof...(Alts)) ? payload : 0>::value, std::enable_if<true, __NicheStorage<payload, Alts...>>,
+					std::enable_if<true, __TaggedStorage<trivial, Alts...>>>::type>;
+		};
+	}
+
+	/*
+	 * Algebraic data type holding exactly one of its (distinct) alternatives, laid out to be as small as possible
+	 *	The tag is the smallest unsigned type that fits, or is left out completely when the alternatives fit in the
+	 *	niches of the one non-empty alternative (see `niche_traits`). Matcher dispatches on it like a `std::variant`
+	 *
+	 *	using Lookup = shl::option<const Node*>;					// Pointer-sized
+	 *	shl::match(lookup)
+	 *		| [](const Node* n) { ... }
+	 *		|| [](shl::none_t) { ... };
+	 */
+	template<class... Alts>
+	class adt : public impl::__ADTLayout<Alts...>::type, impl::__CopyGuard<(... && (std::is_copy_constructible<Alts>::value && std::is_copy_assignable<Alts>::value))> {
+		private:
+			using storage = typename impl::__ADTLayout<Alts...>::type;
+
+			// The alternative a value initializes: the one of the same type, or the only one it can construct
+			template<class T>
+			struct alternative {
+				private:
+					static constexpr size_t exact = impl::__IndexOf<bool, true, 0, std::is_same<std::decay_t<T>, Alts>::value...>::value;
+					static constexpr size_t constructible = impl::__IndexOf<bool, true, 0, std::is_constructible<Alts, T>::value...>::value;
+					static constexpr size_t candidates = (size_t{ 0 } + ... + std::is_constructible<Alts, T>::value);
+
+				public:
+					static constexpr size_t value = exact != size_t(NOT_FOUND) ? exact : candidates == 1 ? constructible : NOT_FOUND;
+			};
+
+		public:
+			static_assert(sizeof...(Alts) > 0, "adt needs at least one alternative");
+
+			using types = std::tuple<Alts...>;
+			using adt_type = adt;											// Also names the adt a recursive type derives from
+
+			// Hold the first alternative
+			adt() { this->template construct<0>(); }
+
+			template<class T, class = std::enable_if_t<!std::is_same<std::decay_t<T>, adt>::value && alternative<T>::value != size_t(NOT_FOUND)>>
+			adt(T&& val) { this->template construct<alternative<T>::value>(std::forward<T>(val)); }
+
+			template<class T, class = std::enable_if_t<!std::is_same<std::decay_t<T>, adt>::value && alternative<T>::value != size_t(NOT_FOUND)>>
+			adt& operator=(T&& val) {
+				this->template construct<alternative<T>::value>(std::forward<T>(val));
+				return *this;
+			}
+
+			template<class T, class... Args>
+			void emplace(Args&&... args) {
+				this->template construct<impl::__IndexOf<bool, true, 0, std::is_same<T, Alts>::value...>::value>(std::forward<Args>(args)...);
+			}
+
+			template<class T>
+			bool holds() const { return this->index() == impl::__IndexOf<bool, true, 0, std::is_same<T, Alts>::value...>::value; }
+
+			// Only after an alternative's constructor threw while replacing the value
+			bool valueless_by_exception() const { return this->index() == sizeof...(Alts); }
+	};
+
+	// ADT that either holds a T or nothing
+	template<class T>
+	using option = adt<none_t, T>;
+
+
+	namespace impl {
+
+		// Covers classes deriving from an adt too (ie. recursive types, see `rec`)
+		template<class T>
+		struct __SumType<T, std::void_t<typename T::adt_type>> : std::true_type {
+			static constexpr size_t size = std::tuple_size<typename T::types>::value;
+
+			static size_t index(const typename T::adt_type& v) {
+				return v.valueless_by_exception() ? throw std::bad_variant_access{} : v.index();
+			}
+
+			template<size_t I, class V>
+			static constexpr decltype(auto) get(V&& v) {
+				return std::forward<V>(v).template value<I>();
+			}
+		};
+	}
+}
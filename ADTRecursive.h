@@ -0,0 +1,402 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ADT.h"
+#include "MatchBuilder.h"
+
+namespace shl {
+
+	/*
+	 * Monotonic arena for the nodes of recursive types: allocation bumps a pointer through large blocks, nothing is freed
+	 *	on its own and `release` (or the destructor) frees every block at once. Blocks double in size up to 1MiB
+	 *	Objects that aren't trivially destructible have their destructor recorded (in the arena) and run on release, newest first
+	 */
+	class arena {
+		private:
+			struct __Block {
+				__Block* prev;
+				size_t size;
+			};
+
+			struct __Cleanup {
+				void (*destroy)(void*);
+				void* obj;
+				__Cleanup* next;
+			};
+
+			static constexpr size_t max_block = size_t{ 1 } << 20;
+
+			unsigned char* cur = nullptr;
+			unsigned char* end = nullptr;
+			__Block* blocks = nullptr;
+			__Cleanup* cleanups = nullptr;
+			size_t next_size;
+
+			// Start a new block with room for at least `size` bytes at `align`
+			void grow(size_t size, size_t align) {
+				auto need = sizeof(__Block) + size + align;
+				auto bytes = std::max(next_size, need);
+				next_size = std::min(next_size * 2, max_block);
+
+				auto block = ::new (::operator new(bytes)) __Block{ blocks, bytes };
+				blocks = block;
+				cur = reinterpret_cast<unsigned char*>(block + 1);
+				end = reinterpret_cast<unsigned char*>(block) + bytes;
+			}
+
+		public:
+			explicit arena(size_t block_size = 4096) : next_size{ std::max(block_size, sizeof(__Block) * 2) } {}
+
+			arena(arena&& other) noexcept
+				: cur{ std::exchange(other.cur, nullptr) }, end{ std::exchange(other.end, nullptr) }, blocks{ std::exchange(other.blocks, nullptr) },
+				  cleanups{ std::exchange(other.cleanups, nullptr) }, next_size{ other.next_size } {}
+
+			arena& operator=(arena&& other) noexcept {
+				if (this != &other) {
+					release();
+					cur = std::exchange(other.cur, nullptr);
+					end = std::exchange(other.end, nullptr);
+					blocks = std::exchange(other.blocks, nullptr);
+					cleanups = std::exchange(other.cleanups, nullptr);
+					next_size = other.next_size;
+				}
+
+				return *this;
+			}
+
+			~arena() { release(); }
+
+			void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+				auto space = static_cast<size_t>(end - cur);
+				void* p = cur;
+
+				if (!cur || !std::align(align, size, p, space)) {
+					grow(size, align);
+					space = static_cast<size_t>(end - cur);
+					p = cur;
+					std::align(align, size, p, space);
+				}
+
+				cur = static_cast<unsigned char*>(p) + size;
+				return p;
+			}
+
+			// Construct a T in the arena (it lives until the arena is released)
+			template<class T, class... Args>
+			T* make(Args&&... args) {
+				auto obj = ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+				if constexpr (!std::is_trivially_destructible<T>::value) {
+					auto cleanup = ::new (allocate(sizeof(__Cleanup), alignof(__Cleanup))) __Cleanup{ [](void* p) { static_cast<T*>(p)->~T(); }, obj, cleanups };
+					cleanups = cleanup;
+				}
+
+				return obj;
+			}
+
+			// Destroy every object made in the arena and free its blocks
+			void release() {
+				for (; cleanups; cleanups = cleanups->next)
+					cleanups->destroy(cleanups->obj);
+
+				while (blocks)
+					::operator delete(std::exchange(blocks, blocks->prev));
+
+				cur = end = nullptr;
+			}
+
+			arena(const arena&) = delete;
+			arena& operator=(const arena&) = delete;
+	};
+
+	/*
+	 * Reference to a node of a recursive type, stored in an arena (nodes are immutable once made)
+	 *	The recursive type derives from its adt so it can be named before its alternatives are complete
+	 *
+	 *	struct Expr;
+	 *	struct Num { int value; };
+	 *	struct Add { shl::rec<Expr> lhs, rhs; };
+	 *	struct Neg { shl::rec<Expr> arg; };
+	 *	struct Expr : shl::adt<Num, Add, Neg> { using adt::adt; };
+	 *
+	 *	shl::arena nodes;
+	 *	shl::rec<Expr> e = nodes.make<Expr>(Add{ nodes.make<Expr>(Num{ 1 }), nodes.make<Expr>(Num{ 2 }) });
+	 */
+	template<class T>
+	class rec {
+		private:
+			const T* node = nullptr;
+
+		public:
+			constexpr rec() = default;
+			constexpr rec(const T* node) : node{ node } {}
+
+			constexpr const T& operator*() const { return *node; }
+			constexpr const T* operator->() const { return node; }
+			constexpr const T* get() const { return node; }
+
+			constexpr explicit operator bool() const { return node != nullptr; }
+	};
+
+
+	namespace impl {
+
+		// Fields of an alternative that fold recurses into (references to the folded type itself)
+		template<class T, class E>
+		struct __IsChild : std::is_same<std::decay_t<E>, rec<T>> {};
+
+		template<class T, class Fields>
+		struct __ChildFields;
+
+		template<class T, class... Es>
+		struct __ChildFields<T, std::tuple<Es...>> {
+			private:
+				static constexpr bool is_child[] = { false, __IsChild<T, Es>::value... };			// Leading false keeps it from being empty
+
+			public:
+				static constexpr size_t count = (size_t{ 0 } + ... + __IsChild<T, Es>::value);
+
+				static constexpr std::array<size_t, count> positions() {
+					std::array<size_t, count> pos{};
+					for (size_t i = 0, n = 0; i != sizeof...(Es); ++i)
+						if (is_child[i + 1]) pos[n++] = i;
+
+					return pos;
+				}
+		};
+
+		// The children of the I'th alternative of T (alternatives that aren't products have none)
+		template<class T, class Alt, bool = __TupleView<Alt>::value>
+		struct __Children {
+			static constexpr size_t count = 0;
+
+			template<class Stack>
+			static void push(const Alt&, Stack&) {}
+		};
+
+		template<class T, class Alt>
+		struct __Children<T, Alt, true> {
+			private:
+				using fields = __ChildFields<T, decltype(__TupleView<Alt>::forward(std::declval<const Alt&>()))>;
+				static constexpr auto positions = fields::positions();
+
+				template<class Stack, size_t... Js>
+				static void push(const Alt& alt, Stack& stack, std::index_sequence<Js...>) {
+					[[maybe_unused]] auto refs = __TupleView<Alt>::forward(alt);
+					(stack.push_back(reinterpret_cast<std::uintptr_t>(std::get<positions[count - 1 - Js]>(refs).get())), ...);
+				}
+
+			public:
+				static constexpr size_t count = fields::count;
+
+				// Push the children last to first, so the first child is folded first and the results end up in order
+				template<class Stack>
+				static void push(const Alt& alt, Stack& stack) {
+					push(alt, stack, std::make_index_sequence<count>{});
+				}
+		};
+
+		/*
+		 * Post-order walk of a recursive type over explicit stacks (so the depth of the tree isn't limited by the thread's stack)
+		 *	A node is visited twice: first its children are pushed, then (once they've all been folded) the matcher is called with the
+		 *	node's alternative followed by the results of its children, which replace them on the result stack. Leaves are folded on
+		 *	their first visit. Both passes jump on the alternative's index like `Matcher::dispatch_sum` (branching for up to 4 alternatives)
+		 *
+		 *	The second visit is marked in the low bit of the node's address. Only nodes with children are marked, and those hold a
+		 *	`rec<T>` so they're at least pointer aligned (a {pointer, flag} pair made the walk about 3x slower)
+		 */
+		template<class T, class M, class R>
+		class __Fold {
+			private:
+				using sum = __SumType<T>;
+
+				static constexpr std::uintptr_t expanded = 1;
+				static_assert(alignof(rec<T>) > expanded, "fold marks nodes in the low bit of their address");
+
+				template<size_t I>
+				using alt = std::decay_t<decltype(sum::template get<I>(std::declval<const T&>()))>;
+
+				template<size_t I>
+				using children = __Children<T, alt<I>>;
+
+				std::vector<std::uintptr_t> stack;
+				std::vector<R> results;
+
+				template<size_t I, size_t... Js>
+				R call(const T& node, M& matcher, std::index_sequence<Js...>) {
+					[[maybe_unused]] auto base = results.size() - sizeof...(Js);
+					return matcher(sum::template get<I>(node), std::move(results[base + Js])...);
+				}
+
+				template<size_t I>
+				static void combine(__Fold& fold, const T& node, M& matcher) {
+					constexpr auto count = children<I>::count;
+					R result = fold.template call<I>(node, matcher, std::make_index_sequence<count>{});
+
+					for (size_t i = 0; i != count; ++i) fold.results.pop_back();
+					fold.results.push_back(std::move(result));
+				}
+
+				template<size_t I>
+				static void expand(__Fold& fold, const T& node) {
+					fold.stack.push_back(reinterpret_cast<std::uintptr_t>(&node) | expanded);
+					children<I>::push(sum::template get<I>(node), fold.stack);
+				}
+
+				template<size_t... Is>
+				static constexpr bool leaf(size_t index, std::index_sequence<Is...>) {
+					constexpr bool leaves[] = { (children<Is>::count == 0)... };
+					return leaves[index];
+				}
+
+				template<size_t... Is>
+				static void combine(__Fold& fold, const T& node, M& matcher, size_t index, std::index_sequence<Is...>) {
+					if constexpr (sizeof...(Is) <= 4) {
+						((index == Is ? combine<Is>(fold, node, matcher) : void()), ...);
+					}
+					else {
+						static constexpr void (*table[])(__Fold&, const T&, M&) = { &combine<Is>... };
+						table[index](fold, node, matcher);
+					}
+				}
+
+				template<size_t... Is>
+				static void expand(__Fold& fold, const T& node, size_t index, std::index_sequence<Is...>) {
+					if constexpr (sizeof...(Is) <= 4) {
+						((index == Is ? expand<Is>(fold, node) : void()), ...);
+					}
+					else {
+						static constexpr void (*table[])(__Fold&, const T&) = { &expand<Is>... };
+						table[index](fold, node);
+					}
+				}
+
+			public:
+				R operator()(const T& root, M& matcher) {
+					using alts = std::make_index_sequence<sum::size>;
+					stack.push_back(reinterpret_cast<std::uintptr_t>(&root));
+
+					while (!stack.empty()) {
+						auto top = stack.back();
+						stack.pop_back();
+
+						auto& node = *reinterpret_cast<const T*>(top & ~expanded);
+						auto index = sum::index(node);
+
+						if ((top & expanded) || leaf(index, alts{}))
+							combine(*this, node, matcher, index, alts{});
+						else
+							expand(*this, node, index, alts{});
+					}
+
+					return std::move(results.back());
+				}
+		};
+	}
+
+	/*
+	 * Fold a recursive type bottom-up (a catamorphism), returning the matcher's result for the root
+	 *	Every node is matched with its alternative followed by the results already folded for each of its children (the fields
+	 *	of type `rec<T>`, in order), so there's a case per alternative taking one extra argument per child:
+	 *
+	 *	auto eval = shl::match()
+	 *		| [](const Num& n) { return n.value; }
+	 *		| [](const Add&, int lhs, int rhs) { return lhs + rhs; }
+	 *		|| [](const Neg&, int arg) { return -arg; };
+	 *
+	 *	shl::fold(expr, eval);
+	 *
+	 *	The walk keeps its own stack, so trees of any depth can be folded
+	 *	NOTE: Children have to be set (not null). References to other recursive types are passed along in the alternative unfolded
+	 */
+	template<class T, RES_CLASS Resolver, class Policy, class R, class... Fns>
+	R fold(const T& tree, Matcher<Resolver, Policy, R, Fns...>& matcher) {
+		static_assert(impl::__SumType<T>::value, "fold walks recursive sum types (classes deriving from an adt)");
+		static_assert(!std::is_void<R>::value && !std::is_reference<R>::value, "fold needs a matcher whose cases return values");
+
+		return impl::__Fold<T, Matcher<Resolver, Policy, R, Fns...>, R>{}(tree, matcher);
+	}
+
+	template<class T, RES_CLASS Resolver, class Policy, class R, class... Fns>
+	R fold(rec<T> tree, Matcher<Resolver, Policy, R, Fns...>& matcher) {
+		return fold(*tree, matcher);
+	}
+
+	template<class T, RES_CLASS Resolver, class Policy, class R, class... Fns>
+	R fold(T* tree, Matcher<Resolver, Policy, R, Fns...>& matcher) {
+		return fold(*tree, matcher);
+	}
+
+	/*
+	 * Handles at-site folding (the cases are given like `shl::match(val)`, see `fold(tree, matcher)` for what they're called with)
+	 *
+	 *	shl::fold(expr)
+	 *		| [](const Num& n) { return n.value; }
+	 *		| [](const Add&, int lhs, int rhs) { return lhs + rhs; }
+	 *		|| [](const Neg&, int arg) { return -arg; };
+	 */
+	template<RES_CLASS Resolver, class T, class Cases = impl::__CaseNil<>>
+	class FoldResolver {
+		private:
+			const T& tree;
+			Cases cases;
+
+		public:
+			constexpr FoldResolver(const T& tree) : tree{ tree }, cases{} {}
+			constexpr FoldResolver(const T& tree, Cases cases) : tree{ tree }, cases{ std::move(cases) } {}
+
+			template<class F>
+			constexpr FoldResolver<Resolver, T, impl::__CaseLink<Cases, F>> operator|(F&& fn) && {
+				return{ tree, impl::__CaseLink<Cases, F>{ cases, std::forward<F>(fn) } };
+			}
+
+			template<class F>
+			decltype(auto) operator||(F&& fn) && {
+				using link = impl::__CaseLink<Cases, F>;
+				auto matcher = link{ cases, std::forward<F>(fn) }.template build<typename link::template matcher<Resolver>>();
+				return fold(tree, matcher);
+			}
+
+			// Chains are finished in the expression that started them (see `impl::__CaseLink`)
+			template<class F> void operator|(F&&) & = delete;
+			template<class F> void operator||(F&&) & = delete;
+
+			FoldResolver(FoldResolver&&) = delete;
+			FoldResolver(const FoldResolver&) = delete;
+			FoldResolver& operator=(const FoldResolver&) = delete;
+	};
+
+	// Start folding a recursive type on-site
+	template<RES_CLASS Resolver = DefaultResolver, class T>
+	FoldResolver<Resolver, T> fold(const T& tree) {
+		return tree;
+	}
+
+	template<RES_CLASS Resolver = DefaultResolver, class T>
+	FoldResolver<Resolver, T> fold(rec<T> tree) {
+		return *tree;
+	}
+
+	template<RES_CLASS Resolver = DefaultResolver, class T>
+	FoldResolver<Resolver, std::remove_const_t<T>> fold(T* tree) {
+		return *tree;
+	}
+
+	// Fold with a result type of R (instead of the common type of the cases' results)
+	template<class R, RES_CLASS Resolver = DefaultResolver, class T>
+	FoldResolver<Resolver, T, impl::__CaseNil<R>> fold(const T& tree) {
+		return tree;
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <array>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include "Matcher.h"
+
+namespace shl {
+	namespace impl {
+
+		/*
+		 * Reference to one element of an `adt_vector` (the element's alternative and its position in that alternative's column)
+		 *	Matcher treats it as a sum type, so matching one dispatches straight to the element's case through the jump table
+		 */
+		template<class Columns>
+		struct __ADTRef {
+			Columns* columns;
+			size_t tag;
+			size_t pos;
+		};
+
+		template<class Columns>
+		struct __SumType<__ADTRef<Columns>> : std::true_type {
+			static constexpr size_t size = std::tuple_size<std::remove_const_t<Columns>>::value;
+
+			static constexpr size_t index(const __ADTRef<Columns>& ref) {
+				return ref.tag;
+			}
+
+			template<size_t I, class V>
+			static constexpr decltype(auto) get(V&& ref) {
+				return std::get<I>(*ref.columns)[ref.pos];
+			}
+		};
+	}
+
+	/*
+	 * Sequence of algebraic data type values stored as a structure of arrays
+	 *	Every alternative lives in its own contiguous column (no padding to the largest alternative) and a stream of
+	 *	compact tags keeps the order the values were added in. `Matcher::match_all` runs each case over its column
+	 *	without looking at the tags, iterating (or `match_all(..., shl::in_order)`) walks the tags to visit values in order
+	 *
+	 *	NOTE: Alternatives must be distinct types, and there's no random access (a value's position in its column isn't stored)
+	 */
+	template<class... Alts>
+	class adt_vector {
+		private:
+			using columns_type = std::tuple<std::vector<Alts>...>;
+			using tag_type = impl::__TagFor<sizeof...(Alts)>;
+
+			template<class T>
+			using alternative = std::integral_constant<size_t, impl::__IndexOf<bool, true, 0, std::is_same<T, Alts>::value...>::value>;
+
+			template<class T>
+			using occurrences = std::integral_constant<size_t, (size_t{ 0 } + ... + std::is_same<T, Alts>::value)>;
+
+			columns_type cols;
+			std::vector<tag_type> tags;
+
+			// Forward iterator over the values in the order they were added (keeps a cursor into every column)
+			template<class Columns>
+			class iterator_impl {
+				private:
+					Columns* columns;
+					const tag_type* tag;
+					std::array<size_t, sizeof...(Alts)> pos{};
+
+				public:
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = impl::__ADTRef<Columns>;
+					using difference_type = std::ptrdiff_t;
+					using pointer = void;
+					using reference = impl::__ADTRef<Columns>;
+
+					iterator_impl(Columns* columns, const tag_type* tag) : columns{ columns }, tag{ tag } {}
+
+					reference operator*() const { return { columns, *tag, pos[*tag] }; }
+
+					iterator_impl& operator++() {
+						++pos[*tag++];
+						return *this;
+					}
+
+					iterator_impl operator++(int) {
+						auto prev = *this;
+						++*this;
+						return prev;
+					}
+
+					bool operator==(const iterator_impl& it) const { return tag == it.tag; }
+					bool operator!=(const iterator_impl& it) const { return tag != it.tag; }
+			};
+
+		public:
+			static_assert(sizeof...(Alts) > 0, "adt_vector needs at least one alternative");
+			static_assert((... && (occurrences<Alts>::value == 1)), "adt_vector alternatives must be distinct types");
+
+			using iterator = iterator_impl<columns_type>;
+			using const_iterator = iterator_impl<const columns_type>;
+
+			// Construct a value of alternative T at the end of the sequence
+			template<class T, class... Args>
+			T& emplace_back(Args&&... args) {
+				static_assert(alternative<T>::value != NOT_FOUND, "Type is not an alternative of the adt_vector");
+
+				auto& column = std::get<alternative<T>::value>(cols);
+				column.emplace_back(std::forward<Args>(args)...);
+				tags.push_back(static_cast<tag_type>(alternative<T>::value));
+				return column.back();
+			}
+
+			template<class T>
+			void push_back(T&& val) {
+				emplace_back<std::decay_t<T>>(std::forward<T>(val));
+			}
+
+			// The contiguous column of every value of alternative T (in the order they were added)
+			template<class T>
+			std::vector<T>& column() { return std::get<alternative<T>::value>(cols); }
+
+			template<class T>
+			const std::vector<T>& column() const { return std::get<alternative<T>::value>(cols); }
+
+			// Every column at once (used by Matcher to match one column at a time)
+			columns_type& columns() { return cols; }
+			const columns_type& columns() const { return cols; }
+
+			iterator begin() { return { &cols, tags.data() }; }
+			iterator end() { return { &cols, tags.data() + tags.size() }; }
+			const_iterator begin() const { return { &cols, tags.data() }; }
+			const_iterator end() const { return { &cols, tags.data() + tags.size() }; }
+
+			size_t size() const { return tags.size(); }
+			bool empty() const { return tags.empty(); }
+
+			void reserve(size_t n) { tags.reserve(n); }
+
+			void clear() {
+				std::apply([](auto&... column) { (column.clear(), ...); }, cols);
+				tags.clear();
+			}
+	};
+}
@@ -0,0 +1,529 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+// Coroutine matching needs C++20 coroutines, the header is empty without them
+#ifdef __cpp_impl_coroutine
+
+#include <array>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "MatchBuilder.h"
+
+namespace shl {
+	namespace impl {
+
+		/*
+		 * Per-thread recycling allocator for the coroutine frames of match_task and message_stream
+		 *	Frame sizes are rounded up to 64 bytes and released frames are kept on a free list per size, so once a connection
+		 *	has handled a few messages every new frame reuses the memory of an earlier one. Frames over 4KiB go to `operator new`
+		 *	A frame released on another thread goes to that thread's lists
+		 */
+		class __FramePool {
+			private:
+				static constexpr size_t granule = 64;
+				static constexpr size_t classes = 64;
+
+				struct block {
+					block* next;
+				};
+
+				std::array<block*, classes> free{};
+
+			public:
+				__FramePool() = default;
+
+				~__FramePool() {
+					for (auto head : free)
+						while (head) ::operator delete(std::exchange(head, head->next));
+				}
+
+				static __FramePool& local() {
+					static thread_local __FramePool pool;
+					return pool;
+				}
+
+				void* allocate(size_t n) {
+					auto c = (n + granule - 1) / granule;
+					if (c > classes) return ::operator new(n);
+
+					if (auto b = free[c - 1]) {
+						free[c - 1] = b->next;
+						return b;
+					}
+
+					return ::operator new(c * granule);
+				}
+
+				void release(void* p, size_t n) {
+					auto c = (n + granule - 1) / granule;
+					if (c > classes) return ::operator delete(p);
+
+					free[c - 1] = ::new (p) block{ free[c - 1] };
+				}
+
+				__FramePool(const __FramePool&) = delete;
+				__FramePool& operator=(const __FramePool&) = delete;
+		};
+
+		// Promises inherit their frame's allocation from here
+		struct __PooledFrame {
+			static void* operator new(size_t n) { return __FramePool::local().allocate(n); }
+			static void operator delete(void* p, size_t n) { __FramePool::local().release(p, n); }
+		};
+
+		// Suspend a finished (or yielding) coroutine and resume whoever is waiting on it (symmetric transfer, so the stack doesn't grow)
+		struct __Continue {
+			bool await_ready() const noexcept { return false; }
+
+			template<class P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept { return h.promise().continuation; }
+
+			void await_resume() const noexcept {}
+		};
+
+		// Check whether a type can be `co_await`-ed (through a member `operator co_await` or by being an awaiter itself)
+		template<class T, class = void>
+		struct __HasCoAwait : std::false_type {};
+
+		template<class T>
+		struct __HasCoAwait<T, std::void_t<decltype(std::declval<T>().operator co_await())>> : std::true_type {};
+
+		template<class T, class = void>
+		struct __IsAwaiter : std::false_type {};
+
+		template<class T>
+		struct __IsAwaiter<T, std::void_t<decltype(std::declval<T&>().await_ready()), decltype(std::declval<T&>().await_resume())>> : std::true_type {};
+
+		template<class T>
+		struct __Awaitable : bool_t<__HasCoAwait<T>::value || __IsAwaiter<T>::value> {};
+
+		// The result of `co_await`-ing a T
+		template<class T, bool = __HasCoAwait<T>::value>
+		struct __AwaitResult {
+			using type = decltype(std::declval<T&>().await_resume());
+		};
+
+		template<class T>
+		struct __AwaitResult<T, true> {
+			using type = decltype(std::declval<decltype(std::declval<T>().operator co_await())&>().await_resume());
+		};
+
+		// Sources with a `next()` are streams of messages, anything else is awaited for a single value
+		template<class S, class = void>
+		struct __Stream : std::false_type {};
+
+		template<class S>
+		struct __Stream<S, std::void_t<decltype(std::declval<S&>().next())>> : std::true_type {};
+
+		// Executors that can tell if the calling thread is one of theirs are only hopped onto when it isn't
+		template<class Ex, class = void>
+		struct __KnowsThread : std::false_type {};
+
+		template<class Ex>
+		struct __KnowsThread<Ex, std::void_t<decltype(std::declval<Ex&>().running_in_this_thread())>> : std::true_type {};
+
+		// Move the awaiting coroutine onto the executor (passing its handle, which is the job, so nothing is allocated to wrap it)
+		template<class Ex>
+		struct __Schedule {
+			Ex& executor;
+
+			bool await_ready() {
+				if constexpr (__KnowsThread<Ex>::value)
+					return executor.running_in_this_thread();
+				else
+					return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> h) { executor.execute(h); }
+			void await_resume() const noexcept {}
+		};
+
+
+		/*
+		 * Promise for match_task
+		 *	The task is lazy (it starts when awaited) and hands its result, or its exception, to the coroutine that awaited it
+		 */
+		struct __TaskPromise : __PooledFrame {
+			std::coroutine_handle<> continuation = std::noop_coroutine();
+			std::exception_ptr error;
+
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			__Continue final_suspend() const noexcept { return {}; }
+			void unhandled_exception() { error = std::current_exception(); }
+		};
+
+		template<class T>
+		struct __TaskResult : __TaskPromise {
+			std::optional<T> value;
+
+			template<class V>
+			void return_value(V&& v) { value.emplace(std::forward<V>(v)); }
+
+			T result() {
+				if (error) std::rethrow_exception(error);
+				return std::move(*value);
+			}
+		};
+
+		template<>
+		struct __TaskResult<void> : __TaskPromise {
+			void return_void() const noexcept {}
+
+			void result() {
+				if (error) std::rethrow_exception(error);
+			}
+		};
+
+		/*
+		 * Completion flag for `sync_wait`, set by the thread that finishes the task
+		 *	It's set and notified under the lock, and the waiter can only return once it holds the lock again, so the notifying
+		 *	thread is done with the flag before the waiter's stack (where it lives) goes away
+		 */
+		struct __Done {
+			std::mutex lock;
+			std::condition_variable wake;
+			bool done = false;
+
+			void set() {
+				std::lock_guard<std::mutex> guard{ lock };
+				done = true;
+				wake.notify_one();
+			}
+
+			void wait() {
+				std::unique_lock<std::mutex> guard{ lock };
+				wake.wait(guard, [this] { return done; });
+			}
+		};
+
+		// Coroutine that signals a flag once it's done, so `sync_wait` can block on a task that resumes on another thread
+		struct __Signal {
+			struct promise_type : __PooledFrame {
+				__Done* done = nullptr;
+				std::exception_ptr error;
+
+				__Signal get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+				std::suspend_always initial_suspend() const noexcept { return {}; }
+
+				auto final_suspend() const noexcept {
+					struct notify {
+						bool await_ready() const noexcept { return false; }
+						void await_suspend(std::coroutine_handle<promise_type> h) const noexcept { h.promise().done->set(); }
+						void await_resume() const noexcept {}
+					};
+
+					return notify{};
+				}
+
+				void return_void() const noexcept {}
+				void unhandled_exception() { error = std::current_exception(); }
+			};
+
+			std::coroutine_handle<promise_type> frame;
+		};
+	}
+
+	/*
+	 * Lazy coroutine task, for the cases of an `async_match` (or anything else that's awaited once)
+	 *	Frames come from a per-thread recycling pool, so a task per message doesn't allocate once the pool is warm
+	 */
+	template<class T = void>
+	class match_task {
+		public:
+			struct promise_type : impl::__TaskResult<T> {
+				match_task get_return_object() { return match_task{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			};
+
+		private:
+			std::coroutine_handle<promise_type> frame;
+
+			explicit match_task(std::coroutine_handle<promise_type> frame) : frame{ frame } {}
+
+			struct awaiter {
+				std::coroutine_handle<promise_type> frame;
+
+				bool await_ready() const noexcept { return false; }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+					frame.promise().continuation = awaiting;
+					return frame;
+				}
+
+				T await_resume() { return frame.promise().result(); }
+			};
+
+		public:
+			match_task(match_task&& task) noexcept : frame{ std::exchange(task.frame, {}) } {}
+
+			match_task& operator=(match_task&& task) noexcept {
+				if (this != &task) {
+					if (frame) frame.destroy();
+					frame = std::exchange(task.frame, {});
+				}
+
+				return *this;
+			}
+
+			~match_task() {
+				if (frame) frame.destroy();
+			}
+
+			// Start the task and resume the awaiting coroutine once it's finished
+			awaiter operator co_await() const noexcept { return { frame }; }
+
+			match_task(const match_task&) = delete;
+			match_task& operator=(const match_task&) = delete;
+	};
+
+	/*
+	 * Async generator of messages for `async_match` (`co_yield` each message, `co_return` to end the stream)
+	 *	Messages aren't copied: `next()` hands out a pointer to the yielded object, valid until the next `next()`
+	 *	(null once the stream has ended). The stream's frame comes from the same pool as match_task's
+	 */
+	template<class T>
+	class message_stream {
+		public:
+			struct promise_type : impl::__PooledFrame {
+				T* current = nullptr;
+				std::optional<T> copy;									// Holds messages yielded as const lvalues
+				std::coroutine_handle<> continuation = std::noop_coroutine();
+				std::exception_ptr error;
+
+				message_stream get_return_object() { return message_stream{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+				std::suspend_always initial_suspend() const noexcept { return {}; }
+
+				impl::__Continue final_suspend() noexcept {
+					current = nullptr;
+					return {};
+				}
+
+				impl::__Continue yield_value(T& msg) noexcept {
+					current = std::addressof(msg);
+					return {};
+				}
+
+				impl::__Continue yield_value(T&& msg) noexcept {
+					current = std::addressof(msg);
+					return {};
+				}
+
+				impl::__Continue yield_value(const T& msg) {
+					current = std::addressof(copy.emplace(msg));
+					return {};
+				}
+
+				void return_void() const noexcept {}
+				void unhandled_exception() { error = std::current_exception(); }
+			};
+
+		private:
+			std::coroutine_handle<promise_type> frame;
+
+			explicit message_stream(std::coroutine_handle<promise_type> frame) : frame{ frame } {}
+
+			struct awaiter {
+				std::coroutine_handle<promise_type> frame;
+
+				bool await_ready() const noexcept { return frame.done(); }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+					frame.promise().continuation = awaiting;
+					return frame;
+				}
+
+				T* await_resume() {
+					if (frame.promise().error) std::rethrow_exception(std::exchange(frame.promise().error, nullptr));
+					return frame.done() ? nullptr : frame.promise().current;
+				}
+			};
+
+		public:
+			message_stream(message_stream&& stream) noexcept : frame{ std::exchange(stream.frame, {}) } {}
+
+			~message_stream() {
+				if (frame) frame.destroy();
+			}
+
+			// Resume the stream until it yields its next message (or ends)
+			awaiter next() noexcept { return { frame }; }
+
+			message_stream(const message_stream&) = delete;
+			message_stream& operator=(const message_stream&) = delete;
+			message_stream& operator=(message_stream&&) = delete;
+	};
+
+	// Executor that runs everything on the thread that resumes the match (the default for `async_match`)
+	struct inline_executor {
+		bool running_in_this_thread() const noexcept { return true; }
+
+		template<class F>
+		void execute(F&& fn) const { fn(); }
+	};
+
+	/*
+	 * Run a task on the calling thread and block until it finishes (for `main` and tests, a coroutine should `co_await` instead)
+	 */
+	template<class T>
+	T sync_wait(match_task<T> task) {
+		impl::__Done done;
+		std::optional<std::conditional_t<std::is_void<T>::value, bool, T>> result;
+
+		auto run = [](match_task<T>& task, decltype(result)& result) -> impl::__Signal {
+			if constexpr (std::is_void<T>::value) {
+				co_await task;
+				result.emplace(true);
+			}
+			else {
+				result.emplace(co_await task);
+			}
+		};
+
+		auto signal = run(task, result);
+		signal.frame.promise().done = &done;
+		signal.frame.resume();
+		done.wait();
+
+		auto error = signal.frame.promise().error;
+		signal.frame.destroy();
+		if (error) std::rethrow_exception(error);
+
+		if constexpr (!std::is_void<T>::value)
+			return std::move(*result);
+	}
+
+	namespace impl {
+
+		// The result of `co_await`-ing an async match: the awaited result of coroutine cases, the plain result of the others
+		template<class R, bool = __Awaitable<R>::value>
+		struct __AsyncResult {
+			using type = R;
+		};
+
+		template<class R>
+		struct __AsyncResult<R, true> : __AwaitResult<R> {};
+
+		/*
+		 * The coroutines that run an async match. Their frame (holding the Matcher, the source and the executor) is made once
+		 *	per `async_match`, from the frame pool, and every message is dispatched through the Matcher's compile-time resolution
+		 */
+		template<class R, class M, class S, class Ex>
+		match_task<R> __MatchOnce(M matcher, S source, Ex executor) {
+			co_await __Schedule<std::remove_reference_t<Ex>>{ executor };
+			auto&& val = co_await std::forward<S>(source);
+
+			using result = decltype(matcher(std::forward<decltype(val)>(val)));
+			if constexpr (std::is_void<result>::value)
+				matcher(std::forward<decltype(val)>(val));
+			else if constexpr (!__Awaitable<result>::value)
+				co_return matcher(std::forward<decltype(val)>(val));
+			else if constexpr (std::is_void<R>::value)
+				co_await matcher(std::forward<decltype(val)>(val));
+			else
+				co_return co_await matcher(std::forward<decltype(val)>(val));
+		}
+
+		template<class M, class S, class Ex>
+		match_task<void> __MatchEach(M matcher, S source, Ex executor) {
+			co_await __Schedule<std::remove_reference_t<Ex>>{ executor };
+			auto thread = std::this_thread::get_id();
+
+			while (auto msg = co_await source.next()) {
+				// Only move back to the executor if the stream resumed us on another thread
+				if (std::this_thread::get_id() != thread) {
+					co_await __Schedule<std::remove_reference_t<Ex>>{ executor };
+					thread = std::this_thread::get_id();
+				}
+
+				if constexpr (__Awaitable<decltype(matcher(*msg))>::value)
+					co_await matcher(*msg);
+				else
+					matcher(*msg);
+			}
+		}
+	}
+
+	/*
+	 * Builds the cases of an `async_match` like MatchResolver, then hands them to a coroutine on the final `||`
+	 *	`co_await shl::async_match(source) | ... || ...` awaits a single value from an awaitable source and returns the result of
+	 *	its case. A stream source (a `message_stream` or anything whose `next()` awaits a pointer-like, null at the end) is matched
+	 *	message by message until it ends. Cases may be coroutines returning `match_task` (they're awaited before the next message),
+	 *	but then every callable case has to return the same task type
+	 *
+	 *	The match starts on the executor (anything with `execute(f)` that calls `f()`, given a coroutine handle). After each message
+	 *	of a stream it only moves back to the executor if the stream resumed it on another thread (and, when the executor has
+	 *	`running_in_this_thread()`, that thread isn't one of the executor's)
+	 *
+	 *	NOTE: Lvalue sources and executors are held by reference, rvalues are moved into the match's frame (rvalue executors are
+	 *		held by value until then, so the default `inline_executor` doesn't outlive `async_match`)
+	 */
+	template<RES_CLASS Resolver, class S, class Ex, class Cases = impl::__CaseNil<>>
+	class AsyncMatchResolver {
+		private:
+			using executor_type = std::conditional_t<std::is_lvalue_reference<Ex>::value, Ex, std::decay_t<Ex>>;
+
+			S&& source;
+			executor_type executor;
+			Cases cases;
+
+		public:
+			constexpr AsyncMatchResolver(S&& source, Ex&& executor) : source{ std::forward<S>(source) }, executor{ std::forward<Ex>(executor) }, cases{} {}
+			constexpr AsyncMatchResolver(S&& source, Ex&& executor, Cases cases) : source{ std::forward<S>(source) }, executor{ std::forward<Ex>(executor) }, cases{ std::move(cases) } {}
+
+			template<class F>
+			constexpr AsyncMatchResolver<Resolver, S, Ex, impl::__CaseLink<Cases, F>> operator|(F&& fn) && {
+				return{ std::forward<S>(source), std::forward<Ex>(executor), impl::__CaseLink<Cases, F>{ cases, std::forward<F>(fn) } };
+			}
+
+			template<class F>
+			auto operator||(F&& fn) && {
+				using link = impl::__CaseLink<Cases, F>;
+				using matcher = typename link::template matcher<Resolver>;
+				using source_type = std::conditional_t<std::is_lvalue_reference<S>::value, S, std::decay_t<S>>;
+
+				auto m = link{ cases, std::forward<F>(fn) }.template build<matcher>();
+
+				if constexpr (impl::__Stream<std::remove_reference_t<S>>::value) {
+					return impl::__MatchEach<matcher, source_type, executor_type>(std::move(m), std::forward<S>(source), std::forward<Ex>(executor));
+				}
+				else {
+					using value = typename impl::__AwaitResult<std::remove_reference_t<S>>::type;
+					using result = decltype(std::declval<matcher&>()(std::declval<value>()));
+
+					return impl::__MatchOnce<typename impl::__AsyncResult<result>::type, matcher, source_type, executor_type>(std::move(m), std::forward<S>(source), std::forward<Ex>(executor));
+				}
+			}
+
+			// Chains are finished in the expression that started them (see `impl::__CaseLink`)
+			template<class F> void operator|(F&&) & = delete;
+			template<class F> void operator||(F&&) & = delete;
+
+			AsyncMatchResolver(AsyncMatchResolver&&) = delete;
+			AsyncMatchResolver(const AsyncMatchResolver&) = delete;
+			AsyncMatchResolver& operator=(const AsyncMatchResolver&) = delete;
+	};
+
+	// Start an asynchronous match over an awaitable or a stream of messages (run on the thread that resumes it)
+	template<RES_CLASS Resolver = DefaultResolver, class S>
+	AsyncMatchResolver<Resolver, S, inline_executor> async_match(S&& source) {
+		return { std::forward<S>(source), inline_executor{} };
+	}
+
+	// Start an asynchronous match that runs on the given executor
+	template<RES_CLASS Resolver = DefaultResolver, class S, class Ex>
+	AsyncMatchResolver<Resolver, S, Ex> async_match(S&& source, Ex&& executor) {
+		return { std::forward<S>(source), std::forward<Ex>(executor) };
+	}
+}
+
+#endif
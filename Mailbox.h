@@ -0,0 +1,249 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include "Matcher.h"
+
+namespace shl {
+	namespace impl {
+
+		// Let a sibling hyperthread run while spinning on the mailbox
+		inline void __Relax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+			_mm_pause();
+#endif
+		}
+
+		// Round a mailbox capacity up to a power of 2 (so slots are found with a mask), with room for at least 2 messages
+		inline size_t __SlotCount(size_t capacity) {
+			size_t slots = 2;
+			while (slots < capacity) slots <<= 1;
+			return slots;
+		}
+
+		// Spinning only pays off when the other side can run at the same time
+		inline size_t __DefaultSpins() {
+			static const size_t spins = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+			return spins;
+		}
+	}
+
+	/*
+	 * Bounded lock-free queue of messages for a single consumer, that dispatches them through a Matcher (the actor pattern)
+	 *	Any number of threads can `post` messages (any of Msgs, or anything a `std::variant<Msgs...>` can be built from).
+	 *	One thread at a time takes them out with `drain` / `receive` / `run`, which hands every message to `matcher.match`,
+	 *	so they go through the Matcher's jump table on the variant's index
+	 *
+	 *	Every slot carries a sequence number (Vyukov's bounded queue): a producer claims a slot by moving the tail forward
+	 *	and publishes it by bumping its sequence, the consumer reads the slots in order and hands them back the same way.
+	 *	Posting and draining don't lock anything and don't allocate, the only lock is taken to park an idle consumer (and
+	 *	by a producer waking it)
+	 *
+	 *	NOTE: The matcher's results are discarded. Messages are destroyed as soon as their case returns (or throws)
+	 */
+	template<class M, class... Msgs>
+	class mailbox {
+		public:
+			using message = std::variant<Msgs...>;
+
+			static_assert(std::is_nothrow_move_constructible<message>::value, "mailbox messages must be nothrow move constructible");
+
+		private:
+			struct alignas(64) __Slot {
+				std::atomic<size_t> seq;
+				alignas(message) unsigned char storage[sizeof(message)];
+
+				message& get() { return *std::launder(reinterpret_cast<message*>(storage)); }
+			};
+
+			M matcher;
+			const size_t mask;
+			std::unique_ptr<__Slot[]> slots;
+
+			alignas(64) std::atomic<size_t> tail{ 0 };					// Next slot to claim (shared by the producers)
+			alignas(64) size_t head = 0;								// Next slot to read (owned by the consumer)
+			size_t spins;
+
+			// Read by every `publish`, so kept off the line the consumer writes for every message
+			alignas(64) std::atomic<bool> parked{ false };
+			std::atomic<bool> closed{ false };
+			std::mutex lock;
+			std::condition_variable wake;
+
+			// Claim the next slot, returns nullptr when the mailbox is full
+			__Slot* claim(size_t& pos) {
+				pos = tail.load(std::memory_order_relaxed);
+
+				while (true) {
+					auto& slot = slots[pos & mask];
+					auto diff = static_cast<std::intptr_t>(slot.seq.load(std::memory_order_acquire) - pos);
+
+					if (diff == 0) {
+						if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &slot;
+					}
+					else if (diff < 0)
+						return nullptr;
+					else
+						pos = tail.load(std::memory_order_relaxed);
+				}
+			}
+
+			void publish(__Slot& slot, size_t pos) {
+				slot.seq.store(pos + 1, std::memory_order_release);
+
+				// Pairs with the fence in `park`, so either the consumer sees the message or we see that it's parked
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (parked.load(std::memory_order_relaxed)) {
+					std::lock_guard<std::mutex> guard{ lock };
+					wake.notify_one();
+				}
+			}
+
+			bool ready() const {
+				return slots[head & mask].seq.load(std::memory_order_acquire) == head + 1;
+			}
+
+			// Block the consumer until a message is posted or the mailbox is closed
+			void park() {
+				std::unique_lock<std::mutex> guard{ lock };
+				parked.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				wake.wait(guard, [this] { return ready() || closed.load(std::memory_order_acquire); });
+				parked.store(false, std::memory_order_relaxed);
+			}
+
+			// Hand the slot back to the producers (one lap ahead) even if the case throws
+			struct __Release {
+				mailbox& box;
+				__Slot& slot;
+
+				~__Release() {
+					slot.get().~message();
+					slot.seq.store(box.head + box.mask + 1, std::memory_order_release);
+					++box.head;
+				}
+			};
+
+		public:
+			/*
+			 * Make an empty mailbox with room for `capacity` messages (rounded up to a power of 2)
+			 *	The consumer spins `spins` times on an empty mailbox before parking (and producers on a full one before yielding),
+			 *	by default 4096 times unless there's a single hardware thread
+			 */
+			explicit mailbox(M matcher, size_t capacity = 1024, size_t spins = impl::__DefaultSpins())
+				: matcher{ std::move(matcher) }, mask{ impl::__SlotCount(capacity) - 1 }, slots{ new __Slot[mask + 1] }, spins{ spins }
+			{
+				for (size_t i = 0; i <= mask; ++i)
+					slots[i].seq.store(i, std::memory_order_relaxed);
+			}
+
+			~mailbox() {
+				while (ready()) {
+					auto& slot = slots[head & mask];
+					slot.get().~message();
+					slot.seq.store(head + mask + 1, std::memory_order_relaxed);
+					++head;
+				}
+			}
+
+			size_t capacity() const { return mask + 1; }
+
+			// Queue the message unless the mailbox is full (doesn't block)
+			template<class T>
+			bool try_post(T&& msg) {
+				if constexpr (std::is_nothrow_constructible<message, T&&>::value) {
+					size_t pos;
+					auto slot = claim(pos);
+					if (!slot) return false;
+
+					::new (slot->storage) message(std::forward<T>(msg));
+					publish(*slot, pos);
+					return true;
+				}
+				else {
+					// Build the message before claiming a slot, so a throwing constructor can't leave a hole in the queue
+					message built(std::forward<T>(msg));
+					return try_post(std::move(built));
+				}
+			}
+
+			// Queue the message, spinning (then yielding) while the mailbox is full
+			template<class T>
+			void post(T&& msg) {
+				if constexpr (std::is_nothrow_constructible<message, T&&>::value) {
+					for (size_t i = 0; !try_post(std::forward<T>(msg)); ++i)
+						i < spins ? impl::__Relax() : std::this_thread::yield();
+				}
+				else {
+					post(message(std::forward<T>(msg)));
+				}
+			}
+
+			/*
+			 * Dispatch the messages that are already queued, up to `max` of them, and return how many were matched (doesn't block)
+			 *	Only one thread may drain a mailbox at a time. If a case throws, its message is still removed
+			 */
+			size_t drain(size_t max = std::numeric_limits<size_t>::max()) {
+				size_t count = 0;
+
+				for (; count != max && ready(); ++count) {
+					auto& slot = slots[head & mask];
+					__Release release{ *this, slot };
+					matcher.match(std::move(slot.get()));
+				}
+
+				return count;
+			}
+
+			/*
+			 * Wait for at least one message (spinning, then parking the thread) and dispatch a batch of up to `max` messages
+			 *	Returns 0 only once the mailbox has been closed and emptied
+			 */
+			size_t receive(size_t max = std::numeric_limits<size_t>::max()) {
+				while (true) {
+					if (auto count = drain(max)) return count;
+					if (closed.load(std::memory_order_acquire)) return drain(max);
+
+					for (size_t i = 0; i != spins && !ready(); ++i)
+						impl::__Relax();
+
+					if (!ready()) park();
+				}
+			}
+
+			// Dispatch messages in batches of `batch` until the mailbox is closed and empty, returns how many were matched
+			size_t run(size_t batch = 256) {
+				size_t total = 0;
+				while (auto count = receive(batch)) total += count;
+				return total;
+			}
+
+			// Stop `receive` and `run` from waiting once the queued messages are dispatched (messages can still be posted)
+			void close() {
+				closed.store(true, std::memory_order_release);
+				std::lock_guard<std::mutex> guard{ lock };
+				wake.notify_one();
+			}
+
+			mailbox(const mailbox&) = delete;
+			mailbox& operator=(const mailbox&) = delete;
+	};
+}
@@ -1,46 +1,99 @@
 #pragma once
+#ifdef _MSC_VER
 #pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
 
 #include "Matcher.h"
 
 namespace shl {
+	namespace impl {
+
+		/*
+		 * Links in the chain of cases built up by MatchBuilder and MatchResolver
+		 *	A link only references its case and the previous link, all of which are temporaries that live until the end
+		 *	of the match expression, so adding a case costs the same no matter how many came before it. Once the chain
+		 *	is finished with `||`, every case is forwarded straight into the Matcher's tuple (moved if it was passed
+		 *	as an rvalue, copied if it was an lvalue) without any intermediate tuples
+		 */
+		template<class R = __DeduceResult, class Policy = no_profiling>
+		struct __CaseNil {
+			template<RES_CLASS Resolver, class... Fns>
+			using matcher = Matcher<Resolver, Policy, typename __MatchResult<R, Fns...>::type, Fns...>;
+
+			template<class M, class... Fs>
+			constexpr M build(Fs&&... fns) const {
+				return M{ __InPlaceCases{}, std::forward<Fs>(fns)... };
+			}
+		};
+
+		/*
+		 * Since its case and the previous link are references, a chain (MatchBuilder, MatchResolver, AsyncMatchResolver,
+		 *	FoldResolver) has to be finished in the expression that started it. Their `|` and `||` only take the temporary
+		 *	returned by the previous call, so a chain kept in a variable doesn't compile. Continuing one through `std::move`
+		 *	isn't supported (its links dangle)
+		 */
+		template<class Prev, class F>
+		struct __CaseLink {
+			const Prev& prev;
+			F&& fn;
+
+			template<RES_CLASS Resolver, class... Fns>
+			using matcher = typename Prev::template matcher<Resolver, shl::decay_t<F>, Fns...>;
+
+			template<class M, class... Fs>
+			constexpr M build(Fs&&... fns) const {
+				return prev.template build<M>(std::forward<F>(fn), std::forward<Fs>(fns)...);
+			}
+		};
+	}
 
 	/*
 	 * Builds a Matcher object that can be passed around using operator chaining to add
 	 *	match patterns. A final call to `||` must be performed in order to generate the
 	 *	finalized Matcher (No way of getting around this AFAIK).
+	 *
+	 *	NOTE: The builder only references its cases, so the whole chain must be written in one expression (see `__CaseLink`)
 	 */
-	template<RES_CLASS Resolver, class... Args>
+	template<RES_CLASS Resolver, class Cases = impl::__CaseNil<>>
 	class MatchBuilder {
 		private:
-			std::tuple<Args...> fns;
-
-			template<class F>
-			constexpr auto add_case(F&& fn) {
-				return std::tuple_cat(std::move(fns), std::make_tuple(std::move(fn)));
-			}
+			Cases cases;
 
 		public:
-			constexpr MatchBuilder(std::tuple<Args...>&& fns) : fns{ fns } {}
-			constexpr MatchBuilder(MatchBuilder<Resolver, Args...>&& m) : fns{ std::move(m.fns) } {}
+			constexpr MatchBuilder(Cases cases) : cases{ std::move(cases) } {}
 
 			// Append the new case onto the current list 
 			template<class F>
-			constexpr MatchBuilder<Resolver, Args..., shl::decay_t<F>> operator|(F&& fn) { return add_case(fn); }
+			constexpr MatchBuilder<Resolver, impl::__CaseLink<Cases, F>> operator|(F&& fn) && {
+				return impl::__CaseLink<Cases, F>{ cases, std::forward<F>(fn) };
+			}
 
 			// Add the new case to the current list and return the list as a Matcher instead of a MatchBuilder
 				// This syntax is possibly just a temporary measure (`\` won't compile)
 			template<class F>
-			constexpr Matcher<Resolver, Args..., shl::decay_t<F>> operator||(F&& fn) { return add_case(fn); }
+			constexpr auto operator||(F&& fn) && {
+				using link = impl::__CaseLink<Cases, F>;
+				return link{ cases, std::forward<F>(fn) }.template build<typename link::template matcher<Resolver>>();
+			}
+
+			// Chains are finished in the expression that started them (see `__CaseLink`)
+			template<class F> void operator|(F&&) & = delete;
+			template<class F> void operator||(F&&) & = delete;
 
 			// Delete copy and assignment functions to prevent compilation without a ending operator|| call
 			constexpr MatchBuilder(const MatchBuilder&) = delete;
 			constexpr MatchBuilder& operator=(const MatchBuilder&) = delete;
 	};
 
-	// Interface function for starting a MatchBuilder chain
-	template<RES_CLASS Resolver = DefaultResolver>
-	constexpr MatchBuilder<Resolver> match() {
-		return std::make_tuple();
+	// Interface function for starting a MatchBuilder chain (Policy enables profiling of the Matcher's cases, see `count_cases`)
+	template<RES_CLASS Resolver = DefaultResolver, class Policy = no_profiling>
+	constexpr MatchBuilder<Resolver, impl::__CaseNil<impl::__DeduceResult, Policy>> match() {
+		return impl::__CaseNil<impl::__DeduceResult, Policy>{};
+	}
+
+	// Start a MatchBuilder chain whose Matcher returns R (instead of the common type of the cases' results)
+	template<class R, RES_CLASS Resolver = DefaultResolver, class Policy = no_profiling>
+	constexpr MatchBuilder<Resolver, impl::__CaseNil<R, Policy>> match() {
+		return impl::__CaseNil<R, Policy>{};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,55 @@
+/*
+ * C++20 module interface for the library (`import shl.match;`), compiled once instead of re-parsing the headers in every translation unit
+ *	gcc:	g++ -std=c++20 -fmodules-ts -I. -x c++ MatchModule.cppm -c				(writes gcm.cache/shl.match.gcm)
+ *	clang:	clang++ -std=c++20 -I. -x c++-module MatchModule.cppm --precompile -o shl.match.pcm
+ *
+ *	Every declaration of the headers is exported, macros aren't (include "Matcher.h" for RES_CLASS/RES_DEF to write a resolver)
+ *	The standard headers the library uses are included in the global module fragment so they stay attached to the global module
+ */
+module;
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+export module shl.match;
+
+export {
+#include "ADT.h"
+#include "ADTRecursive.h"
+#include "ADTVector.h"
+#include "AsyncMatch.h"
+#include "Mailbox.h"
+#include "MatchResolver.h"
+#include "ParallelMatch.h"
+}
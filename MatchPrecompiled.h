@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "ADT.h"
+#include "ADTRecursive.h"
+#include "ADTVector.h"
+#include "AsyncMatch.h"
+#include "Mailbox.h"
+#include "MatchResolver.h"
+#include "ParallelMatch.h"
+
+/*
+ * Header to precompile once in place of the library's headers, then force-include into every translation unit
+ *	gcc:	g++ -std=c++17 -I. -x c++-header MatchPrecompiled.h -o MatchPrecompiled.h.gch		(then `-include MatchPrecompiled.h`)
+ *	clang:	clang++ -std=c++17 -I. -x c++-header MatchPrecompiled.h -o MatchPrecompiled.h.pch	(then `-include-pch MatchPrecompiled.h.pch`)
+ *
+ *	Besides the parsed headers, the precompiled header keeps the resolution of every pair of single parameter cases over the
+ *	common types below, so the translation units only instantiate what's particular to their cases. Build flags (-std, -O, -D)
+ *	have to match between the precompiled header and the units that use it
+ *
+ *	Define SHL_PRECOMPILED_TYPES (ie. `-DSHL_PRECOMPILED_TYPES="int, std::string"`) to resolve a different list of types ahead of time.
+ *	The resolutions grow with the cube of the list (8 types are ~190MB of gcc precompiled header)
+ */
+#ifndef SHL_PRECOMPILED_TYPES
+#define SHL_PRECOMPILED_TYPES bool, int, long, unsigned, double, const char*, std::string, std::string_view
+#endif
+
+namespace shl {
+	namespace impl {
+
+		/*
+		 * Instantiate the ranking of every pair of single parameter cases for every argument
+		 *	Arguments reach the resolvers as `T&` or `T` (a forwarded lvalue or rvalue), parameters are taken as `T` or `const T&`
+		 *	The ranking is keyed on the parameters (not on the cases themselves), so it's shared by every case that takes them
+		 */
+		template<class... Ts>
+		struct __Precompile {
+			template<class P0, class A>
+			static constexpr size_t row() {
+				return (size_t{ 0 } + ... + (__TupleDispatch<argpack<P0>, argpack<Ts>, A>::value + __TupleDispatch<argpack<P0>, argpack<const Ts&>, A>::value));
+			}
+
+			template<class A>
+			static constexpr size_t table() {
+				return (size_t{ 0 } + ... + (row<Ts, A>() + row<const Ts&, A>()));
+			}
+
+			static constexpr size_t value = (size_t{ 0 } + ... + (table<Ts&>() + table<Ts>()));
+		};
+
+		inline constexpr size_t __Precompiled = __Precompile<SHL_PRECOMPILED_TYPES>::value;
+	}
+}
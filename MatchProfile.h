@@ -0,0 +1,194 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#include "meta.h"
+
+namespace shl {
+
+	/*
+	 * Instrumentation policies for Matcher (the parameter after the resolver, ie. `shl::match<shl::DefaultResolver, shl::count_cases>()`)
+	 *	no_profiling - Records nothing (the default, the probes compile to nothing)
+	 *	count_cases - Counts how often each case is called
+	 *	time_cases - Counts how often each case is called and how long it runs for (`steady_clock` around every call)
+	 *
+	 *	Every thread counts into its own counters, which are only read (relaxed) when a profile is taken. Counters belong to
+	 *	the Matcher type, so every Matcher built by the same match expression shares them
+	 */
+	struct no_profiling {};
+	struct count_cases {};
+	struct time_cases {};
+
+	// Profile of one case of a Matcher
+	struct case_profile {
+		size_t index;
+		std::string signature;
+		std::uint64_t hits;
+		std::chrono::nanoseconds time;					// Zero unless the cases are timed
+	};
+
+	namespace impl {
+
+		// Readable name of a type (demangled where the ABI has a demangler)
+		template<class T>
+		std::string __TypeName() {
+			auto mangled = typeid(T).name();
+
+#if defined(__GNUG__)
+			int status = 0;
+			if (auto demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status)) {
+				std::string name{ demangled };
+				std::free(demangled);
+				return name;
+			}
+#endif
+
+			return mangled;
+		}
+
+		template<class R, class Args>
+		struct __FunctionType;
+
+		template<class R, class... Args>
+		struct __FunctionType<R, std::tuple<Args...>> {
+			using type = R(Args...);
+		};
+
+		// Label of a case in a profile: a function's signature or a value case's type
+		template<class Fn, bool = callable<Fn>::value>
+		struct __CaseLabel {
+			static std::string name() {
+				return __TypeName<typename __FunctionType<typename function_traits<Fn>::return_type, typename function_traits<Fn>::arg_types>::type>();
+			}
+		};
+
+		template<class Fn>
+		struct __CaseLabel<Fn, false> {
+			static std::string name() { return "value " + __TypeName<Fn>(); }
+		};
+
+		struct __CaseCounter {
+			std::atomic<std::uint64_t> hits{ 0 };
+			std::atomic<std::uint64_t> nanos{ 0 };
+
+			// Only the owning thread adds to its counters, so a relaxed load and store is enough (no locked read-modify-write)
+			static void add(std::atomic<std::uint64_t>& counter, std::uint64_t n) {
+				counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			}
+		};
+
+		// The counters of every thread for the N cases of a Matcher type (and the totals of the threads that have exited)
+		template<size_t N>
+		class __CaseStats {
+			private:
+				std::mutex lock;
+				std::vector<const std::array<__CaseCounter, N>*> threads;
+				std::array<std::uint64_t, N> retired_hits{}, retired_nanos{};
+
+			public:
+				// Counters of one thread, registered on first use and folded into the totals when the thread exits
+				struct local {
+					__CaseStats& stats;
+					std::array<__CaseCounter, N> counters;
+
+					local(__CaseStats& stats) : stats{ stats } {
+						std::lock_guard<std::mutex> guard{ stats.lock };
+						stats.threads.push_back(&counters);
+					}
+
+					~local() {
+						std::lock_guard<std::mutex> guard{ stats.lock };
+						for (size_t i = 0; i != N; ++i) {
+							stats.retired_hits[i] += counters[i].hits.load(std::memory_order_relaxed);
+							stats.retired_nanos[i] += counters[i].nanos.load(std::memory_order_relaxed);
+						}
+
+						for (auto& thread : stats.threads)
+							if (thread == &counters) {
+								thread = stats.threads.back();
+								stats.threads.pop_back();
+								break;
+							}
+					}
+
+					local(const local&) = delete;
+					local& operator=(const local&) = delete;
+				};
+
+				std::vector<case_profile> profile(std::array<std::string, N> signatures) {
+					std::lock_guard<std::mutex> guard{ lock };
+					std::vector<case_profile> cases;
+
+					for (size_t i = 0; i != N; ++i) {
+						auto hits = retired_hits[i], nanos = retired_nanos[i];
+						for (auto thread : threads) {
+							hits += (*thread)[i].hits.load(std::memory_order_relaxed);
+							nanos += (*thread)[i].nanos.load(std::memory_order_relaxed);
+						}
+
+						cases.push_back({ i, std::move(signatures[i]), hits, std::chrono::nanoseconds{ nanos } });
+					}
+
+					return cases;
+				}
+		};
+
+		/*
+		 * Records the calls to the cases of a Matcher type (Key) for a profiling policy
+		 *	`scope<I>` - Created around each call to the I'th case
+		 *	`stats` - Every thread's counters
+		 */
+		template<class Policy, class Key, size_t N>
+		struct __Probe {
+			template<size_t I>
+			struct scope {};
+		};
+
+		template<class Key, size_t N>
+		struct __Probe<count_cases, Key, N> {
+			static __CaseStats<N>& stats() {
+				static __CaseStats<N> all;
+				return all;
+			}
+
+			static std::array<__CaseCounter, N>& counters() {
+				static thread_local typename __CaseStats<N>::local mine{ stats() };
+				return mine.counters;
+			}
+
+			template<size_t I>
+			struct scope {
+				scope() { __CaseCounter::add(counters()[I].hits, 1); }
+			};
+		};
+
+		template<class Key, size_t N>
+		struct __Probe<time_cases, Key, N> : __Probe<count_cases, Key, N> {
+			template<size_t I>
+			struct scope {
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+				~scope() {
+					auto& counter = __Probe::counters()[I];
+					__CaseCounter::add(counter.hits, 1);
+					__CaseCounter::add(counter.nanos, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+				}
+			};
+		};
+	}
+}
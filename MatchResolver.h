@@ -1,5 +1,7 @@
 #pragma once
+#ifdef _MSC_VER
 #pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
 
 #include "MatchBuilder.h"
 
@@ -10,29 +12,36 @@ namespace shl {
 	 *	NOTE: MatchResolver's pattern **must** end with a `||` call since match resolution is performed there.
 	 *		Currently, there is no way of notifying the programmer at compile time if they've forgotten the `||`.
 	 */
-	template<RES_CLASS Resolver, class T, class... Fns>
+	template<RES_CLASS Resolver, class T, class Cases = impl::__CaseNil<>>
 	class MatchResolver {
 		private:
-			T&& val;						// I don't have to worry about `val` "scope-leaking" because MatchResolver's guaranteed to use it in the current scope (if the constructors are deleted)
-			MatchBuilder<Resolver, Fns...> builder;
+			// I don't have to worry about `val` "scope-leaking" because MatchResolver's guaranteed to use it in the current scope (if the constructors are deleted)
+				// Several values are held as a tuple of references to them
+			std::conditional_t<impl::__IsArgs<T>::value, T, T&&> val;
+			Cases cases;					// References the cases (and the previous resolver's links), which live until the `||` call
 
 		public:
-			constexpr MatchResolver(T&& val) : val{ std::forward<T>(val) }, builder{ std::make_tuple() } {}
-			constexpr MatchResolver(T&& val, MatchBuilder<Resolver, Fns...>&& fns) : val{ std::forward<T>(val) }, builder{ std::move(fns) } {}
+			constexpr MatchResolver(T&& val) : val{ std::forward<T>(val) }, cases{} {}
+			constexpr MatchResolver(T&& val, Cases cases) : val{ std::forward<T>(val) }, cases{ std::move(cases) } {}
 			// Can't implement an "error" destructor because of all the temporaries (no way of enforcing a future match)
 
 			template<class F>
-			constexpr MatchResolver<Resolver, T, Fns..., shl::decay_t<F>> operator|(F&& fn) {
-				return{ std::forward<T>(val), builder | fn };			// Should I `forward` or `move` the function
+			constexpr MatchResolver<Resolver, T, impl::__CaseLink<Cases, F>> operator|(F&& fn) && {
+				return{ std::forward<T>(val), impl::__CaseLink<Cases, F>{ cases, std::forward<F>(fn) } };
 			}
 
-			// Handle resolution immediately once the `||` operator is used
+			// Handle resolution immediately once the `||` operator is used (returns the result of the chosen case)
 			template<class F>
-			constexpr auto operator||(F&& fn) {
-				return (builder || fn).match(std::forward<T>(val));
+			constexpr decltype(auto) operator||(F&& fn) && {
+				using link = impl::__CaseLink<Cases, F>;
+				return link{ cases, std::forward<F>(fn) }.template build<typename link::template matcher<Resolver>>().match(std::forward<T>(val));
 			}
 
 
+			// Chains are finished in the expression that started them (see `impl::__CaseLink`)
+			template<class F> void operator|(F&&) & = delete;
+			template<class F> void operator||(F&&) & = delete;
+
 			// Comment out to allow for "match-currying" (I need to fix `val` to ensure no leakage first)
 			constexpr MatchResolver(MatchResolver&&) = delete;
 			constexpr MatchResolver(const MatchResolver&) = delete;
@@ -43,4 +52,20 @@ namespace shl {
 	template<RES_CLASS Resolver = DefaultResolver, class T> constexpr MatchResolver<Resolver, T> match(T&& val) {
 		return std::forward<T>(val);
 	}
+
+	// Perform a match on-site that returns R (instead of the common type of the cases' results)
+	template<class R, RES_CLASS Resolver = DefaultResolver, class T> constexpr MatchResolver<Resolver, T, impl::__CaseNil<R>> match(T&& val) {
+		return std::forward<T>(val);
+	}
+
+	// Perform a match on several values at once (see `Matcher::operator()(T0&&, T1&&, Ts&&...)`)
+	template<RES_CLASS Resolver = DefaultResolver, class T0, class T1, class... Ts>
+	constexpr MatchResolver<Resolver, impl::__Args<T0, T1, Ts...>> match(T0&& v0, T1&& v1, Ts&&... vs) {
+		return impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) };
+	}
+
+	template<class R, RES_CLASS Resolver = DefaultResolver, class T0, class T1, class... Ts>
+	constexpr MatchResolver<Resolver, impl::__Args<T0, T1, Ts...>, impl::__CaseNil<R>> match(T0&& v0, T1&& v1, Ts&&... vs) {
+		return impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) };
+	}
 }
\ No newline at end of file
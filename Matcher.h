@@ -1,6 +1,24 @@
 #pragma once
+#ifdef _MSC_VER
 #pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
 
+#include <algorithm>
+#include <any>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "MatchProfile.h"
 #include "meta.h"
 
 // Macros to ease resolver creation and use in templates
@@ -15,22 +33,564 @@
 
 
 namespace shl {
+
+	/*
+	 * Declares a closed class hierarchy so Matcher can dispatch a `Base&` / `Base*` on its dynamic type without RTTI
+	 *	Specialize `hierarchy_of<Base>` from `closed_hierarchy<Base, Derived...>` and give it a static `tag(const Base&)`
+	 *	returning the position of the object's dynamic type in the list (`tag_of<T>()` produces those positions)
+	 *
+	 *	struct Shape { const size_t kind; };
+	 *	template<> struct hierarchy_of<Shape> : closed_hierarchy<Shape, Circle, Square> {
+	 *		static size_t tag(const Shape& s) { return s.kind; }
+	 *	};
+	 */
+	template<class Base>
+	struct hierarchy_of {};
+
+	template<class Base, class... Derived>
+	struct closed_hierarchy {
+		using types = std::tuple<Base, Derived...>;
+
+		template<class T>
+		static constexpr size_t tag_of() {
+			constexpr bool is[] = { std::is_same<T, Base>::value, std::is_same<T, Derived>::value... };
+			static_assert(std::is_same<T, Base>::value || std::is_base_of<Base, T>::value, "Type is not part of the hierarchy");
+
+			for (size_t i = 0; i != sizeof...(Derived) + 1; ++i)
+				if (is[i]) return i;
+
+			return NOT_FOUND;
+		}
+	};
+
+	namespace impl {
+		template<class P, class F>
+		struct __PatternCase;
+	}
+
+	/*
+	 * Value patterns for integral and enum values, written `pattern(case)` (ie. `shl::val<0>([] { ... })`)
+	 *	`val<Vs...>` matches any of the constants, `range<Lo, Hi>` every value from Lo to Hi (inclusive)
+	 *	The case is called with the value, with nothing or is a value itself, like any other case. Values that no pattern
+	 *	matches go on to the cases for their type. Like the labels of a `switch`, patterns can't overlap
+	 */
+	template<auto... Vs>
+	struct val_t {
+		template<class F>
+		constexpr impl::__PatternCase<val_t, std::decay_t<F>> operator()(F&& fn) const { return { *this, std::forward<F>(fn) }; }
+	};
+
+	template<auto... Vs>
+	inline constexpr val_t<Vs...> val{};
+
+	template<auto Lo, auto Hi>
+	struct range_t {
+		static_assert(!(Hi < Lo), "A range pattern's bounds are the wrong way around");
+
+		template<class F>
+		constexpr impl::__PatternCase<range_t, std::decay_t<F>> operator()(F&& fn) const { return { *this, std::forward<F>(fn) }; }
+	};
+
+	template<auto Lo, auto Hi>
+	inline constexpr range_t<Lo, Hi> range{};
+
+	/*
+	 * String pattern for `std::string_view`, `std::string` and `const char*` values, written `shl::str("GET")(case)`
+	 *	A value is only compared against the patterns of its length (found through a jump table on the length), with a
+	 *	`memcmp` of that constant length. Of two equal patterns, the first one wins
+	 */
+	template<size_t N>
+	struct str_t {
+		char text[N];
+
+		template<class F>
+		constexpr impl::__PatternCase<str_t, std::decay_t<F>> operator()(F&& fn) const { return { *this, std::forward<F>(fn) }; }
+	};
+
+	template<size_t N>
+	constexpr str_t<N> str(const char(&text)[N]) {
+		str_t<N> pattern{};
+		for (size_t i = 0; i != N; ++i)
+			pattern.text[i] = text[i];
+
+		return pattern;
+	}
+
+	/*
+	 * Guard pattern for conditions only known at runtime, written `shl::when(pred)(case)`
+	 *	A value is tested against every guard whose predicate takes it before any other case, in the order they were written,
+	 *	and the first guard that holds picks its case. Values that no guard holds for go on to the other patterns and cases
+	 *
+	 *	`shl::when(pred, shl::commutative)` marks a guard as free to be tested in any order among the commutative guards
+	 *	written next to it (they don't overlap, or it doesn't matter which of them wins). Every thread counts how often the
+	 *	guards of such a run hold and tests the 4 that held most often first (in descending order), then the rest in written
+	 *	order. Counts are halved every 4096 hits so the order follows changes in the traffic
+	 */
+	struct commutative_t {};
+	inline constexpr commutative_t commutative{};
+
+	template<class Pred, bool Commutative = false>
+	struct when_t {
+		Pred pred;
+
+		template<class F>
+		constexpr impl::__PatternCase<when_t, std::decay_t<F>> operator()(F&& fn) const& { return { *this, std::forward<F>(fn) }; }
+		template<class F>
+		constexpr impl::__PatternCase<when_t, std::decay_t<F>> operator()(F&& fn) && { return { std::move(*this), std::forward<F>(fn) }; }
+	};
+
+	template<class Pred>
+	constexpr when_t<std::decay_t<Pred>> when(Pred&& pred) {
+		return { std::forward<Pred>(pred) };
+	}
+
+	template<class Pred>
+	constexpr when_t<std::decay_t<Pred>, true> when(Pred&& pred, commutative_t) {
+		return { std::forward<Pred>(pred) };
+	}
+
 	namespace impl {
 
 		/*
-		 * Given a pack sequence, find the location of the first `val`
-		 *	Is there a way to do this with constexpr ???
+		 * Given a pack sequence, find the location of the first `val` (offset by N)
+		 *	The pack is searched as an array, so the cost doesn't grow with a recursion per element
 		 */
+		template<class T, size_t M>
+		constexpr size_t __FirstOf(const T(&matches)[M], T val, size_t N) {
+			for (size_t i = 0; i != M; ++i)
+				if (matches[i] == val) return N + i;
+
+			return NOT_FOUND;
+		}
+
 		template<class T, T val, size_t N, T match, T... matches>
 		struct __IndexOf {
-			static constexpr size_t value = (match == val) ? N : __IndexOf<T, val, N + 1, matches...>::value;
+			private:
+				static constexpr T list[] = { match, matches... };
+
+			public:
+				static constexpr size_t value = __FirstOf(list, val, N);
+		};
+
+		// Forward a value with the value category of `V` (used to pass along alternatives and the contents of a `std::any`)
+		template<class V, class U>
+		using __ForwardLike_t = std::conditional_t<std::is_lvalue_reference<V>::value, U&, U&&>;
+
+		/*
+		 * Describes how Matcher dispatches on a sum type (a type holding one of a fixed list of alternatives)
+		 *	Matcher resolves a case for every alternative at compile time and jumps to the active one's case at runtime
+		 *
+		 *	`size` - The number of alternatives
+		 *	`index` - The index of the active alternative
+		 *	`get<I>` - Access the I'th alternative, keeping the value category of the sum object
+		 */
+		template<class T, class = void>
+		struct __SumType : std::false_type {};
+
+		template<class... Ts>
+		struct __SumType<std::variant<Ts...>> : std::true_type {
+			static constexpr size_t size = sizeof...(Ts);
+
+			static constexpr size_t index(const std::variant<Ts...>& v) {
+				return v.valueless_by_exception() ? throw std::bad_variant_access{} : v.index();
+			}
+
+			// Only called for the active alternative, so the index check `std::get` would repeat is skipped (`get_if` never returns null here)
+			template<size_t I, class V>
+			static constexpr decltype(auto) get(V&& v) {
+				return static_cast<__ForwardLike_t<V, std::remove_pointer_t<decltype(std::get_if<I>(&v))>>>(*std::get_if<I>(&v));
+			}
+		};
+
+		// Closed hierarchies are sum types over their classes, the alternatives are reached by `static_cast`
+		template<class Base>
+		struct __SumType<Base, std::void_t<typename hierarchy_of<Base>::types>> : std::true_type {
+			private:
+				using types = typename hierarchy_of<Base>::types;
+
+			public:
+				static constexpr size_t size = std::tuple_size<types>::value;
+
+				static constexpr size_t index(const Base& v) {
+					return hierarchy_of<Base>::tag(v);
+				}
+
+				template<size_t I, class V>
+				static constexpr decltype(auto) get(V&& v) {
+					using alt = std::conditional_t<std::is_const<std::remove_reference_t<V>>::value, const std::tuple_element_t<I, types>, std::tuple_element_t<I, types>>;
+					return static_cast<__ForwardLike_t<V, alt>>(v);
+				}
+		};
+
+		// Pointers into a closed hierarchy dispatch to the pointer type of the dynamic class (null pointers stay `Base*`)
+		template<class Base>
+		struct __SumType<Base*, std::void_t<typename hierarchy_of<std::remove_cv_t<Base>>::types>> : std::true_type {
+			private:
+				using types = typename hierarchy_of<std::remove_cv_t<Base>>::types;
+
+			public:
+				static constexpr size_t size = std::tuple_size<types>::value;
+
+				static constexpr size_t index(const Base* v) {
+					return v ? hierarchy_of<std::remove_cv_t<Base>>::tag(*v) : 0;
+				}
+
+				template<size_t I, class V>
+				static constexpr auto get(V&& v) {
+					using alt = std::conditional_t<std::is_const<Base>::value, const std::tuple_element_t<I, types>, std::tuple_element_t<I, types>>;
+					return static_cast<alt*>(v);
+				}
+		};
+
+		// Smallest unsigned type that can hold N distinct tags
+		template<size_t N>
+		using __TagFor = std::conditional_t<(N <= UINT8_MAX + 1), std::uint8_t,
+			std::conditional_t<(N <= UINT16_MAX + 1), std::uint16_t, std::uint32_t>>;
+
+		// Constant array of function pointers for runtime indexing
+		template<class F, F... fns>
+		struct __JumpTable {
+			static constexpr F value[] = { fns... };
+		};
+
+
+		/*
+		 * Describes how Matcher decomposes a product type into its elements
+		 *	Tuple-like types (anything `std::tuple_size` is defined for) are split with `get`, simple aggregates with
+		 *	structured bindings. Aggregates have their field count detected by brace-initializing them from N
+		 *	placeholders, so they're limited to 8 fields that aren't references, arrays or base classes (aggregates
+		 *	that don't fit aren't decomposed, only cases that take them whole are)
+		 *
+		 *	`forward` - A tuple of references to each element, keeping the value category of the product object
+		 */
+		template<class T, class = void>
+		struct __TupleView : std::false_type {};
+
+		// Reference to an element that keeps the value category of the product object (reference elements stay as they are)
+		template<class V, class E>
+		using __ElementRef_t = std::conditional_t<std::is_reference<E>::value, E, __ForwardLike_t<V, E>>;
+
+		template<class T, class = void>
+		struct __TupleLike : std::false_type {};
+
+		template<class T>
+		struct __TupleLike<T, std::void_t<decltype(std::tuple_size<T>::value)>> : std::true_type {};
+
+		template<class T>
+		struct __TupleView<T, std::enable_if_t<__TupleLike<T>::value>> : std::true_type {
+			private:
+				template<class V, size_t... Is>
+				static constexpr auto forward(V&& v, std::index_sequence<Is...>) {
+					using std::get;
+					return std::forward_as_tuple(get<Is>(std::forward<V>(v))...);
+				}
+
+			public:
+				template<class V>
+				static constexpr auto forward(V&& v) {
+					return forward(std::forward<V>(v), std::make_index_sequence<std::tuple_size<T>::value>{});
+				}
+		};
+
+		// Placeholder that converts to any field type
+		struct __AnyField {
+			template<class T> operator T() const;
+		};
+
+		template<class T, class Is, class = void>
+		struct __BracesWith : std::false_type {};
+
+		template<class T, size_t... Is>
+		struct __BracesWith<T, std::index_sequence<Is...>, std::void_t<decltype(T{ (void(Is), __AnyField{})... })>> : std::true_type {};
+
+		// Same, with every placeholder in its own braces (which turns off brace elision, so an array field takes a single one)
+		template<class T, class Is, class = void>
+		struct __NestedBracesWith : std::false_type {};
+
+		template<class T, size_t... Is>
+		struct __NestedBracesWith<T, std::index_sequence<Is...>, std::void_t<decltype(T{ { (void(Is), __AnyField{}) }... })>> : std::true_type {};
+
+		// Placeholder that only converts to the bases of T (they come before the fields)
+		template<class T>
+		struct __AnyBase {
+			template<class B, class = std::enable_if_t<std::is_base_of<B, T>::value && !std::is_same<B, T>::value>> operator B() const;
+		};
+
+		template<class T, class = void>
+		struct __HasBase : std::false_type {};
+
+		template<class T>
+		struct __HasBase<T, std::void_t<decltype(T{ __AnyBase<T>{} })>> : std::true_type {};
+
+		// The most placeholders (up to N) that T can be brace-initialized from
+		template<class T, template<class, class, class> class Braces, size_t N>
+		struct __MostBraces : std::conditional_t<Braces<T, std::make_index_sequence<N>, void>::value, std::integral_constant<size_t, N>, __MostBraces<T, Braces, N - 1>> {};
+
+		template<class T, template<class, class, class> class Braces>
+		struct __MostBraces<T, Braces, 0> : std::integral_constant<size_t, 0> {};
+
+		/*
+		 * Number of fields of an aggregate, or 0 if they can't be counted exactly
+		 *	Brace elision lets an array field take one placeholder per element, so the count is checked against the nested
+		 *	braces count (unless the fields can't be list-initialized from a placeholder, like `std::string_view`)
+		 */
+		template<class T, size_t N = __MostBraces<T, __BracesWith, 8>::value, size_t Nested = __MostBraces<T, __NestedBracesWith, N>::value>
+		struct __FieldCount : std::integral_constant<size_t,
+			(__BracesWith<T, std::make_index_sequence<N + 1>>::value || __HasBase<T>::value || (Nested != 0 && Nested != N)) ? 0 : N> {};
+
+		// Only count the fields of aggregates that aren't already tuple-like
+		template<class T, bool = std::is_aggregate<T>::value && !std::is_array<T>::value && !__TupleLike<T>::value>
+		struct __AggregateFields : __FieldCount<T> {};
+
+		template<class T>
+		struct __AggregateFields<T, false> : std::integral_constant<size_t, 0> {};
+
+		// Forward the fields bound by a structured binding (each field is deduced without its reference)
+		template<class V, class... Es>
+		constexpr auto __ForwardFields(Es&... es) {
+			return std::forward_as_tuple(static_cast<__ElementRef_t<V, Es>>(es)...);
+		}
+
+		// Structured bindings can't introduce a pack, so every field count gets its own specialization
+		template<size_t N>
+		struct __Fields;
+
+#define FIELDS_IMPL(N, ...) \
+		template<> struct __Fields<N> { \
+			template<class V> static constexpr auto forward(V&& v) { \
+				auto& [__VA_ARGS__] = v; \
+				return __ForwardFields<V>(__VA_ARGS__); \
+			} \
+		}
+
+		FIELDS_IMPL(1, f0);
+		FIELDS_IMPL(2, f0, f1);
+		FIELDS_IMPL(3, f0, f1, f2);
+		FIELDS_IMPL(4, f0, f1, f2, f3);
+		FIELDS_IMPL(5, f0, f1, f2, f3, f4);
+		FIELDS_IMPL(6, f0, f1, f2, f3, f4, f5);
+		FIELDS_IMPL(7, f0, f1, f2, f3, f4, f5, f6);
+		FIELDS_IMPL(8, f0, f1, f2, f3, f4, f5, f6, f7);
+#undef FIELDS_IMPL
+
+		template<class T>
+		struct __TupleView<T, std::enable_if_t<(__AggregateFields<T>::value > 0)>> : std::true_type {
+			template<class V>
+			static constexpr auto forward(V&& v) {
+				return __Fields<__AggregateFields<T>::value>::forward(std::forward<V>(v));
+			}
+		};
+
+		// Result of applying a tuple of references to F (no `type` if F can't take them, unlike `decltype(std::apply(...))`)
+		template<class F, class Tuple>
+		struct __ApplyResult {};
+
+		template<class F, class... Es>
+		struct __ApplyResult<F, std::tuple<Es...>> : std::invoke_result<F, Es...> {};
+
+		// Result of applying the elements of T to F, only looked for when F can't take T whole
+		template<bool, class F, class T, bool = __TupleView<std::decay_t<T>>::value>
+		struct __DecomposedResult {};
+
+		template<class F, class T>
+		struct __DecomposedResult<true, F, T, true> : __ApplyResult<F, decltype(__TupleView<std::decay_t<T>>::forward(std::declval<T>()))> {};
+
+
+		/*
+		 * Structs to dispatch a `std::any` on the type it holds
+		 *	Every case contributes its (unqualified) parameter type, Matcher resolves a case for each of those types
+		 *	and a hash table keyed on `typeid` picks the thunk for the stored type with a single lookup
+		 */
+		template<class Params>
+		struct __AnyCandidate {
+			using type = void;
+		};
+
+		template<class Param>
+		struct __AnyCandidate<argpack<Param>> {
+			private:
+				using param = std::remove_cv_t<std::remove_reference_t<Param>>;
+
+			public:
+				// `std::any` can't hold arrays or functions (and a case taking the `std::any` is not a stored type)
+				using type = std::conditional_t<std::is_array<param>::value || std::is_function<param>::value || std::is_same<param, std::any>::value, void, param>;
+		};
+
+		// Cases taking several arguments are called with a held tuple (mirrors tuple application)
+		template<class P0, class P1, class... Params>
+		struct __AnyCandidate<argpack<P0, P1, Params...>> {
+			using type = std::tuple<std::decay_t<P0>, std::decay_t<P1>, std::decay_t<Params>...>;
+		};
+
+		template<class Fn, bool = callable<Fn>::value>
+		struct __AnyCaseType : __AnyCandidate<typename function_traits<Fn>::arg_types> {};
+
+		template<class Fn>
+		struct __AnyCaseType<Fn, false> : __AnyCandidate<void> {};
+
+		/*
+		 * Open addressing (linear probing) table from `std::type_info` to a dispatch thunk
+		 *	Lookups probe by the address of the `type_info` first and only hash the type's name (`hash_code`) when
+		 *	the address isn't known (ie. the same type has several `type_info` objects across shared libraries)
+		 *	Capacity is the next power of two that keeps the load factor at or below 1/2
+		 */
+		template<class Thunk, size_t N>
+		class __AnyTable {
+			private:
+				static constexpr size_t capacity() {
+					size_t cap = 2;
+					while (cap < 2 * N) cap *= 2;
+					return cap;
+				}
+
+				struct Slot {
+					const std::type_info* type = nullptr;
+					Thunk thunk = nullptr;
+				};
+
+				std::array<Slot, capacity()> by_address{};
+				std::array<Slot, capacity()> by_name{};
+
+				static size_t address_of(const std::type_info& type) {
+					return reinterpret_cast<std::uintptr_t>(&type) / alignof(std::type_info);
+				}
+
+			public:
+				__AnyTable(std::initializer_list<std::pair<const std::type_info*, Thunk>> entries) {
+					for (auto& entry : entries)
+						if (entry.first) insert(*entry.first, entry.second);
+				}
+
+				// Keep the first thunk registered for a type (later ones resolve to the same case anyway)
+				void insert(const std::type_info& type, Thunk thunk) {
+					auto i = type.hash_code() & (capacity() - 1);
+					while (by_name[i].type && *by_name[i].type != type)
+						i = (i + 1) & (capacity() - 1);
+
+					if (by_name[i].type) return;
+					by_name[i] = Slot{ &type, thunk };
+
+					auto j = address_of(type) & (capacity() - 1);
+					while (by_address[j].type)
+						j = (j + 1) & (capacity() - 1);
+
+					by_address[j] = Slot{ &type, thunk };
+				}
+
+				Thunk find(const std::type_info& type) const {
+					for (auto i = address_of(type) & (capacity() - 1); by_address[i].type; i = (i + 1) & (capacity() - 1))
+						if (by_address[i].type == &type) return by_address[i].thunk;
+
+					for (auto i = type.hash_code() & (capacity() - 1); by_name[i].type; i = (i + 1) & (capacity() - 1))
+						if (*by_name[i].type == type) return by_name[i].thunk;
+
+					return nullptr;
+				}
 		};
 
-		template<class T, T val, size_t N, T match >
-		struct __IndexOf<T, val, N, match> {
-			static constexpr size_t value = (match == val) ? N : NOT_FOUND;
+		// Produce the `typeid` of T, or nullptr for void
+		template<class T>
+		const std::type_info* __TypeId() { return &typeid(T); }
+
+		template<>
+		inline const std::type_info* __TypeId<void>() { return nullptr; }
+
+
+		// Tag to construct a Matcher's cases directly from the arguments that make them
+		struct __InPlaceCases {};
+
+		// Tags selecting how Matcher dispatches on a value
+		struct __ValueDispatch {};				// Resolve a case for the static type of the value
+		struct __SumDispatch {};				// Resolve a case for every alternative and jump to the active one
+		struct __AnyDispatch {};				// Look up the case for the type held by a `std::any`
+
+		struct __MultipleDispatch {};			// Resolve a case for every combination of several values' alternatives and jump to the active one
+
+		// Several values matched at once (`shl::match(a, b)`, `Matcher::operator()(a, b)`), held by reference until the match
+		template<class... Ts>
+		struct __Args {
+			std::tuple<Ts&&...> refs;
 		};
 
+		template<class T>
+		struct __IsArgs : std::false_type {};
+
+		template<class... Ts>
+		struct __IsArgs<__Args<Ts...>> : std::true_type {};
+
+		template<class T>
+		using __DispatchOf = std::conditional_t<__SumType<T>::value, __SumDispatch,
+			std::conditional_t<std::is_same<T, std::any>::value, __AnyDispatch,
+			std::conditional_t<__IsArgs<T>::value, __MultipleDispatch, __ValueDispatch>>>;
+
+		template<class T>
+		struct __IsVariant : std::false_type {};
+
+		template<class... Ts>
+		struct __IsVariant<std::variant<Ts...>> : std::true_type {};
+
+		template<bool, RES_CLASS Resolver, class T, class... Fns>
+		struct __TakesWhole : std::false_type {};
+
+		template<RES_CLASS Resolver, class T, class... Fns>
+		struct __TakesWhole<true, Resolver, T, Fns...> : bool_t<Resolver<T, Fns...>::value != NOT_FOUND> {};
+
+		// A variant is only split into its alternatives when no case takes the variant itself
+		template<RES_CLASS Resolver, class T, class... Fns>
+		using __DispatchFor = std::conditional_t<__TakesWhole<__IsVariant<std::decay_t<T>>::value, Resolver, T, Fns...>::value, __ValueDispatch, __DispatchOf<std::decay_t<T>>>;
+
+		// One of several values matched at once, as a sum type (values that aren't sum types have a single alternative, themselves)
+		template<class T, bool = __SumType<std::decay_t<T>>::value>
+		struct __DispatchArg {
+			static constexpr size_t size = 1;
+
+			static constexpr size_t index(const std::remove_reference_t<T>&) { return 0; }
+
+			template<size_t I, class V>
+			static constexpr V&& get(V&& v) { return std::forward<V>(v); }
+		};
+
+		template<class T>
+		struct __DispatchArg<T, true> : __SumType<std::decay_t<T>> {};
+
+		/*
+		 * Flattened N-dimensional table of the combinations of several values' alternatives
+		 *	Cells are laid out row-major (the last value's alternative varies fastest), so a combination's cell is its
+		 *	alternative indices read as a mixed radix number
+		 */
+		template<class Args>
+		struct __DispatchGrid;
+
+		template<class... Ts>
+		struct __DispatchGrid<std::tuple<Ts...>> {
+			static constexpr size_t sizes[] = { __DispatchArg<Ts>::size... };
+			static constexpr size_t cells = (size_t{ 1 } * ... * __DispatchArg<Ts>::size);
+
+			// The alternative of the J'th value in cell K
+			static constexpr size_t coordinate(size_t K, size_t J) {
+				for (size_t i = sizeof...(Ts); i-- > J + 1;)
+					K /= sizes[i];
+
+				return K % sizes[J];
+			}
+
+			static constexpr size_t cell(const std::remove_reference_t<Ts>&... vals) {
+				size_t k = 0;
+				((k = k * __DispatchArg<Ts>::size + __DispatchArg<Ts>::index(vals)), ...);
+				return k;
+			}
+		};
+
+		// Ranges that store each alternative in its own column (`columns()` returns a tuple of ranges, ie. `adt_vector`)
+		struct __ColumnDispatch {};				// Run the cases over every column in turn
+
+		template<class T, class = void>
+		struct __ColumnStore : std::false_type {};
+
+		template<class T>
+		struct __ColumnStore<T, std::void_t<decltype(std::declval<T&>().columns())>> : std::true_type {};
+
+
 		/*
 		 * Helper struct for Matcher that handles all function dispatching without creating
 		 *  fatal compiler errors through mutually exclusive `std::enable_if` specializations
@@ -41,42 +601,405 @@ namespace shl {
 		 *	Can possibly clean up SFINAE functions when `if constexpr` is implemented
 		 */
 		struct __MatchHelper {
-			// Dispatch to the base case (callable<F> == true if base_case<F> == true)
+			// Dispatch to the base case
 			template<class F, class T>
-			static std::enable_if_t<base_case<F>::value> invoke(F&& fn, T&& val) {
-				fn();
+			static constexpr auto invoke(F&& fn, T&&) -> std::enable_if_t<base_case<F>::value && callable<F>::value, decltype(fn())> {
+				return fn();
 			}
 
 			// Dispatch to a function that accepts arguments
 			template<class F, class T>
-			static std::enable_if_t<!base_case<F>::value && callable<F>::value> invoke(F&& fn, T&& val) {
-				fn(std::forward<T>(val));
+			static constexpr std::enable_if_t<!base_case<F>::value && std::is_invocable<F, T>::value, std::invoke_result_t<F, T>> invoke(F&& fn, T&& val) {
+				return fn(std::forward<T>(val));
 			}
 
-			// Apply tuple to the chosen function (only created if the function takes the decomposed tuple)
-			template<class F, class... T>
-			static std::enable_if_t<!base_case<F>::value && impl::takes_args<callable<F>::value, F, shl::decay_t<T>...>::value> invoke(F&& fn, std::tuple<T...> val) {
-				std::apply(std::forward<F>(fn), std::forward<std::tuple<T...>>(val));
+			// Apply the elements of a tuple, pair, array or aggregate to the chosen function (only created if the function takes the decomposed value)
+				// Elements are passed by reference with the value category of `val`, so nothing is copied unless a parameter asks for a copy
+				// Several values matched at once arrive as a tuple of references, so they're applied to their case here too
+			template<class F, class T>
+			static constexpr auto invoke(F&& fn, T&& val) -> typename __DecomposedResult<!base_case<F>::value && callable<F>::value && !std::is_invocable<F, T>::value, F, T>::type {
+				return std::apply(std::forward<F>(fn), __TupleView<std::decay_t<T>>::forward(std::forward<T>(val)));
 			}
 
-			// Dispatch to a tuple pack
-			// TODO: Multiple arguments are unimplemented
-
-			// Dispatch to a non-function value
+			// Dispatch to a non-function value (a constant result for any value that no other case takes)
 			template<class F, class T>
-			static std::enable_if_t<!callable<F>::value> invoke(F&& fn, T&& val) {
-				fn;
+			static constexpr std::enable_if_t<!callable<F>::value, std::decay_t<F>> invoke(F&& fn, T&&) {
+				return fn;
 			}
 
 			// I can remove this and the size_t template (see commented code in Matcher), but this makes nicer compiler errors
-			template<size_t N, class T, class... Args>
-			static void nice_invoke(std::tuple<Args...>& fns, T&& val) {
-				invoke(std::get<N>(fns), std::forward<T>(val));
+				// The case's result is returned as a prvalue of R, so a case returning R itself constructs it straight into the caller
+			template<size_t N, class R, class T, class... Args>
+			static constexpr R nice_invoke(std::tuple<Args...>& fns, T&& val) {
+				using result = decltype(invoke(std::get<N>(fns), std::forward<T>(val)));
+				static_assert(std::is_void<R>::value || std::is_same<result, R>::value || std::is_convertible<result, R>::value, "The chosen case's result can't be converted to the result type of the match");
+
+				return static_cast<R>(invoke(std::get<N>(fns), std::forward<T>(val)));
+			}
+
+			// Call the case of the N'th function's value pattern (the pattern has already matched the value)
+			template<size_t N, class R, class T, class... Args>
+			static constexpr R pattern_invoke(std::tuple<Args...>& fns, T&& val) {
+				using result = decltype(invoke(std::get<N>(fns).fn, std::forward<T>(val)));
+				static_assert(std::is_void<R>::value || std::is_same<result, R>::value || std::is_convertible<result, R>::value, "The chosen case's result can't be converted to the result type of the match");
+
+				return static_cast<R>(invoke(std::get<N>(fns).fn, std::forward<T>(val)));
 			}
 
 		};
+
+
+		/*
+		 * Determine the result type of a Matcher
+		 *	An explicit R (`shl::match<R>()`) is used as is, otherwise the result is the `std::common_type` of every case's result
+		 *	(a function's return type or a value case's own type), or void if the results have no common type
+		 */
+		struct __DeduceResult {};
+
+		template<bool, class Fn>
+		struct __CaseResult {
+			using type = typename function_traits<Fn>::return_type;
+		};
+
+		template<class Fn>
+		struct __CaseResult<false, Fn> {
+			using type = std::decay_t<Fn>;
+		};
+
+		template<class, class... Ts>
+		struct __CommonResult {
+			using type = void;
+		};
+
+		template<class... Ts>
+		struct __CommonResult<std::void_t<std::common_type_t<Ts...>>, Ts...> : std::common_type<Ts...> {};
+
+		template<class R, class... Fns>
+		struct __MatchResult {
+			using type = R;
+		};
+
+		template<class... Fns>
+		struct __MatchResult<__DeduceResult, Fns...> : __CommonResult<void, typename __CaseResult<callable<Fns>::value, Fns>::type...> {};
+
+
+		/*
+		 * Resolve a case against the elements of a pair, array or aggregate (Matcher's fallback when no case takes the value itself)
+		 *	std::tuple is left out since the resolvers already consider its decomposition
+		 */
+		template<class T>
+		struct __StdTuple : std::false_type {};
+
+		template<class... Ts>
+		struct __StdTuple<std::tuple<Ts...>> : std::true_type {};
+
+		template<bool, RES_CLASS Resolver, class T, class... Fns>
+		struct __DecomposedCase {
+			static constexpr size_t value = NOT_FOUND;
+		};
+
+		template<RES_CLASS Resolver, class T, class... Fns>
+		struct __DecomposedCase<true, Resolver, T, Fns...> {
+			static constexpr size_t value = Resolver<decltype(__TupleView<std::decay_t<T>>::forward(std::declval<T>())), Fns...>::value;
+		};
 		
 
+		/*
+		 * Lookup of the value patterns of a case list for integral or enum values of type T
+		 *	Every pattern is an interval of K tagged with its case's index. Densely packed patterns (spanning at most 1024 values,
+		 *	a quarter of which are matched) become a jump table indexed by the value, others a binary search over the intervals
+		 */
+		template<class P, class F>
+		struct __PatternCase {
+			P pattern;
+			F fn;
+		};
+
+		template<class Fn>
+		struct __IsPatternCase : std::false_type {};
+
+		template<class P, class F>
+		struct __IsPatternCase<__PatternCase<P, F>> : std::true_type {};
+
+		// Pattern cases only match their constants, so they're never base cases and their result is their case's
+		template<class P, class F>
+		struct __BaseCase<false, __PatternCase<P, F>> : std::false_type {};
+
+		template<class P, class F>
+		struct __CaseResult<false, __PatternCase<P, F>> : __CaseResult<callable<F>::value, F> {};
+
+		template<class P, class F>
+		struct __CaseLabel<__PatternCase<P, F>, false> {
+			static std::string name() { return __TypeName<P>() + "(" + __CaseLabel<F>::name() + ")"; }
+		};
+
+		template<class K>
+		struct __PatternInterval {
+			K lo, hi;
+			size_t fn;
+		};
+
+		template<class T>
+		using __PatternKey_t = typename std::conditional_t<std::is_enum<T>::value, std::underlying_type<T>, std::enable_if<true, T>>::type;
+
+		// Constants only match values of their own enum, and integer constants only match integers that can hold them
+		template<class T, auto V>
+		constexpr bool __PatternApplies() {
+			using K = __PatternKey_t<T>;
+
+			if constexpr (std::is_enum<decltype(V)>::value || std::is_enum<T>::value)
+				return std::is_same<decltype(V), T>::value;
+			else if constexpr (std::is_integral<decltype(V)>::value)
+				return (V < 0) ? std::is_signed<K>::value && static_cast<long long>(V) >= static_cast<long long>(std::numeric_limits<K>::min())
+					: static_cast<unsigned long long>(V) <= static_cast<unsigned long long>(std::numeric_limits<K>::max());
+			else
+				return false;
+		}
+
+		// The intervals of a case's pattern that apply to values of type T
+		template<class T, class Fn>
+		struct __PatternKeys {
+			static constexpr std::array<__PatternInterval<__PatternKey_t<T>>, 0> intervals{};
+		};
+
+		template<class T, auto... Vs, class F>
+		struct __PatternKeys<T, __PatternCase<val_t<Vs...>, F>> {
+			private:
+				using K = __PatternKey_t<T>;
+
+				static constexpr auto collect() {
+					std::array<__PatternInterval<K>, (size_t{ 0 } + ... + __PatternApplies<T, Vs>())> all{};
+					size_t n = 0;
+					((__PatternApplies<T, Vs>() ? void(all[n++] = { static_cast<K>(Vs), static_cast<K>(Vs), 0 }) : void()), ...);
+					return all;
+				}
+
+			public:
+				static constexpr auto intervals = collect();
+		};
+
+		template<class T, auto Lo, auto Hi, class F>
+		struct __PatternKeys<T, __PatternCase<range_t<Lo, Hi>, F>> {
+			private:
+				using K = __PatternKey_t<T>;
+				static constexpr bool applies = __PatternApplies<T, Lo>() && __PatternApplies<T, Hi>();
+
+				static constexpr auto collect() {
+					std::array<__PatternInterval<K>, applies> all{};
+					if constexpr (applies) all[0] = { static_cast<K>(Lo), static_cast<K>(Hi), 0 };
+					return all;
+				}
+
+			public:
+				static constexpr auto intervals = collect();
+		};
+
+		template<class T, class... Fns>
+		struct __PatternTable {
+			private:
+				using K = __PatternKey_t<T>;
+
+				template<size_t... Is>
+				static constexpr auto collect(std::index_sequence<Is...>) {
+					std::array<__PatternInterval<K>, (size_t{ 0 } + ... + __PatternKeys<T, Fns>::intervals.size())> all{};
+					size_t n = 0;
+
+					auto add = [&](const auto& intervals, size_t fn) {
+						for (auto interval : intervals) {
+							interval.fn = fn;
+							all[n++] = interval;
+						}
+					};
+					(add(__PatternKeys<T, Fns>::intervals, Is), ...);
+
+					// Insertion sort by the lower bound
+					for (size_t i = 1; i < all.size(); ++i)
+						for (size_t j = i; j != 0 && all[j].lo < all[j - 1].lo; --j) {
+							auto tmp = all[j];
+							all[j] = all[j - 1];
+							all[j - 1] = tmp;
+						}
+
+					return all;
+				}
+
+				static constexpr unsigned long long width(K lo, K hi) {
+					return static_cast<unsigned long long>(hi) - static_cast<unsigned long long>(lo) + 1;
+				}
+
+				static constexpr bool check_disjoint() {
+					for (size_t i = 1; i < intervals.size(); ++i)
+						if (!(intervals[i - 1].hi < intervals[i].lo)) return false;
+
+					return true;
+				}
+
+				static constexpr unsigned long long count_matched() {
+					unsigned long long matched = 0;
+					for (auto& interval : intervals)
+						matched += width(interval.lo, interval.hi);
+
+					return matched;
+				}
+
+			public:
+				static constexpr auto intervals = collect(std::index_sequence_for<Fns...>{});
+				static constexpr bool disjoint = check_disjoint();
+
+				static constexpr unsigned long long span = intervals.empty() ? 0 : width(intervals.front().lo, intervals.back().hi);
+				static constexpr bool dense = disjoint && span != 0 && span <= 1024 && count_matched() * 4 >= span;
+
+				// Index of the case whose pattern holds k, or NOT_FOUND
+				static constexpr size_t find(K k) {
+					size_t lo = 0, hi = intervals.size();
+					while (lo != hi) {
+						auto mid = lo + (hi - lo) / 2;
+						if (k < intervals[mid].lo) hi = mid;
+						else if (intervals[mid].hi < k) lo = mid + 1;
+						else return intervals[mid].fn;
+					}
+
+					return NOT_FOUND;
+				}
+		};
+
+		// Values that value patterns are looked up for (integers and enums with at least one pattern that applies to them)
+		template<bool, class T, class... Fns>
+		struct __PatternedImpl : std::false_type {};
+
+		template<class T, class... Fns>
+		struct __PatternedImpl<true, T, Fns...> : bool_t<(... || (__PatternKeys<T, Fns>::intervals.size() != 0))> {};
+
+		template<class T, class... Fns>
+		struct __Patterned : __PatternedImpl<std::is_integral<T>::value || std::is_enum<T>::value, T, Fns...> {};
+
+
+		// Length of a case's string pattern (NOT_FOUND if it isn't one)
+		template<class Fn>
+		struct __StringLength {
+			static constexpr size_t value = NOT_FOUND;
+		};
+
+		template<size_t N, class F>
+		struct __StringLength<__PatternCase<str_t<N>, F>> {
+			static constexpr size_t value = N - 1;
+		};
+
+		template<class T>
+		struct __StringValue : bool_t<std::is_same<T, std::string_view>::value || std::is_same<T, std::string>::value
+			|| std::is_same<T, const char*>::value || std::is_same<T, char*>::value> {};
+
+		// Values that string patterns are looked up for
+		template<class T, class... Fns>
+		struct __StringPatterned : bool_t<__StringValue<T>::value && (... || (__StringLength<Fns>::value != size_t(NOT_FOUND)))> {};
+
+		template<size_t L, class... Fns>
+		struct __HasString : bool_t<(... || (__StringLength<Fns>::value == L))> {};
+
+		// The longest string pattern
+		template<class... Fns>
+		struct __LongestString {
+			static constexpr size_t value = std::max({ size_t{ 0 }, (__StringLength<Fns>::value != size_t(NOT_FOUND) ? __StringLength<Fns>::value : 0)... });
+		};
+
+
+		// Whether a case is a guard whose predicate takes an lvalue of type T
+		template<class T, class Fn>
+		struct __GuardFor : std::false_type {
+			static constexpr bool commutative = false;
+		};
+
+		template<class T, class Pred, bool C, class F>
+		struct __GuardFor<T, __PatternCase<when_t<Pred, C>, F>> : bool_t<std::is_invocable_r<bool, Pred&, T&>::value> {
+			static constexpr bool commutative = C;
+		};
+
+		// A guard's case and the positions [run, end) of its run among the guards (commutative neighbours share one)
+		struct __GuardSlot {
+			size_t fn, run, end;
+		};
+
+		template<class T, class... Fns>
+		struct __GuardTable {
+			private:
+				static constexpr auto collect() {
+					constexpr bool guard[] = { false, __GuardFor<T, Fns>::value... };
+					constexpr bool commutes[] = { false, (__GuardFor<T, Fns>::value && __GuardFor<T, Fns>::commutative)... };
+					std::array<__GuardSlot, (size_t{ 0 } + ... + __GuardFor<T, Fns>::value)> all{};
+					size_t n = 0;
+
+					for (size_t i = 0; i != sizeof...(Fns); ++i)
+						if (guard[i + 1]) {
+							auto joins = n != 0 && commutes[i + 1] && commutes[all[n - 1].fn + 1];
+							all[n] = { i, joins ? all[n - 1].run : n, n + 1 };
+							for (auto k = all[n].run; k != n; ++k) all[k].end = n + 1;
+							++n;
+						}
+
+					return all;
+				}
+
+			public:
+				static constexpr auto slots = collect();
+		};
+
+		// How many of a run's guards are tested in hit count order before the rest are tested in written order
+		inline constexpr size_t __HotGuards = 4;
+
+		/*
+		 * Order in which a thread tests N guards, kept sorted by hit count within every run
+		 *	`order` is the guard at every position and `rank` the position of every guard. Counts are halved every 4096 hits
+		 */
+		template<size_t N>
+		struct __GuardOrder {
+			std::array<size_t, N> order, rank;
+			std::array<std::uint32_t, N> hits{};
+
+			__GuardOrder() {
+				for (size_t i = 0; i != N; ++i)
+					order[i] = rank[i] = i;
+			}
+
+			// Count a hit of the guard at position i and move it ahead of the guards of its run that held less often
+			void hit(size_t i, size_t run) {
+				if (++hits[order[i]] == 4096)
+					for (auto& h : hits) h /= 2;
+
+				for (; i != run && hits[order[i - 1]] < hits[order[i]]; --i) {
+					std::swap(order[i - 1], order[i]);
+					rank[order[i - 1]] = i - 1;
+					rank[order[i]] = i;
+				}
+			}
+		};
+
+
+		/*
+		 * Check that a case can be called through a const Matcher (functions, values and lambdas that aren't `mutable`)
+		 *	Pattern cases check their case and a guard's predicate too
+		 */
+		template<class Call>
+		struct __ConstCall : std::false_type {};
+
+		template<class C, class R, class... Args>
+		struct __ConstCall<R(C::*)(Args...) const> : std::true_type {};
+
+		template<class C, class R, class... Args>
+		struct __ConstCall<R(C::*)(Args...) const noexcept> : std::true_type {};
+
+		template<class Fn, class = void>
+		struct __ConstCase : std::true_type {};
+
+		template<class Fn>
+		struct __ConstCase<Fn, std::void_t<decltype(&Fn::operator())>> : __ConstCall<decltype(&Fn::operator())> {};
+
+		template<class P, class F>
+		struct __ConstCase<__PatternCase<P, F>> : __ConstCase<F> {};
+
+		template<class Pred, bool C, class F>
+		struct __ConstCase<__PatternCase<when_t<Pred, C>, F>> : bool_t<__ConstCase<Pred>::value && __ConstCase<F>::value> {};
+
+
 		/*
 		 * Struct to determine the best function to match the arguments according to C++ function resolution rules
 		 * This struct is designed in such a way to be used to recursively "iterate" over the possible functions
@@ -99,8 +1022,143 @@ namespace shl {
 		};
 
 		RES_IMPL_R(__DefaultResolverImpl) {
-			static constexpr auto value = better ? __DefaultResolverImpl<N, N + 1, Arg, F, Fns...>::value		// The new function was a better match
+			static constexpr auto value = __DefaultResolverImpl<I, N, Arg, Curr, F>::better ? __DefaultResolverImpl<N, N + 1, Arg, F, Fns...>::value		// The new function was a better match
 				: __DefaultResolverImpl<I, N + 1, Arg, Curr, Fns...>::value;									// The old function was a better match
+
+			using type = std::conditional_t<__DefaultResolverImpl<I, N, Arg, Curr, F>::better, typename __DefaultResolverImpl<N, N + 1, Arg, F, Fns...>::type,
+				typename __DefaultResolverImpl<I, N + 1, Arg, Curr, Fns...>::type>;
+		};
+
+
+		/*
+		 * Structs to run the function list as a knockout tournament for TournamentResolver
+		 *	Every case enters the bracket tagged with its index, ranges of the bracket are resolved by splitting
+		 *	them in half and letting the winner of each half play off against the other with `better_match`
+		 *
+		 * Note: The earlier (left) winner is kept unless the later one is strictly better, so ties still go to the first case
+		 *		 Nesting depth is O(log N) and each case is only compared O(log N) times
+		 */
+		template<size_t I, class F>
+		struct __Entrant {
+			static constexpr size_t value = I;
+			using type = F;
+		};
+
+		template<class Is, class... Fns>
+		struct __Bracket;
+
+		template<size_t... Is, class... Fns>
+		struct __Bracket<std::index_sequence<Is...>, Fns...> : __Entrant<Is, Fns>... {};
+
+		// Pick the I'th entrant out of the bracket through overload resolution (avoids recursing on the pack)
+		template<size_t I, class F>
+		__Entrant<I, F> __SeedOf(const __Entrant<I, F>&);
+
+		template<class Arg, class Bracket, size_t Lo, size_t Hi, bool = (Hi - Lo == 1)>
+		struct __TournamentImpl {
+			private:
+				using left = __TournamentImpl<Arg, Bracket, Lo, Lo + (Hi - Lo) / 2>;
+				using right = __TournamentImpl<Arg, Bracket, Lo + (Hi - Lo) / 2, Hi>;
+
+				static constexpr bool better = better_match<typename left::type, typename right::type, Arg>::value;
+
+			public:
+				static constexpr size_t value = better ? right::value : left::value;
+				using type = std::conditional_t<better, typename right::type, typename left::type>;
+		};
+
+		template<class Arg, class Bracket, size_t Lo, size_t Hi>
+		struct __TournamentImpl<Arg, Bracket, Lo, Hi, true> : decltype(__SeedOf<Lo>(std::declval<Bracket>())) {};
+
+
+		/*
+		 * Check that the best case of a resolution is strictly better than every other case in the list (for StrictResolver)
+		 */
+		template<class Arg, class Res, class Is, class... Fns>
+		struct __Unambiguous;
+
+		template<class Arg, class Res, size_t... Is, class... Fns>
+		struct __Unambiguous<Arg, Res, std::index_sequence<Is...>, Fns...>
+			: bool_t<((Is == Res::value || better_match<Fns, typename Res::type, Arg>::value) && ...)> {};
+
+
+		/*
+		 * Find the cases that would convert the value into a temporary that allocates (for AllocAwareResolver and NoAllocResolver)
+		 *	A parameter allocates if the value only reaches it through a user-defined conversion to a type that is neither trivially
+		 *	constructed from the value nor trivially destroyed (ie. `const char*` -> `std::string`, but not -> `std::string_view`)
+		 *	Cases that take a tuple's elements are checked against each element
+		 */
+		template<class P, class A>
+		struct __AllocatingParam {
+			private:
+				using temp = std::remove_cv_t<std::remove_reference_t<P>>;
+
+			public:
+				static constexpr bool value = IsUserConvertable<P, A>::value && !std::is_trivially_constructible<temp, A>::value && !std::is_trivially_destructible<temp>::value;
+		};
+
+		template<bool, class Ps, class As>
+		struct __AllocatingCall : std::false_type {};
+
+		template<class... Ps, class... As>
+		struct __AllocatingCall<true, argpack<Ps...>, argpack<As...>> : bool_t<(__AllocatingParam<Ps, As>::value || ...)> {};
+
+		template<class Ps, class As>
+		struct __AllocatingArgs;
+
+		template<class... Ps, class... As>
+		struct __AllocatingArgs<argpack<Ps...>, argpack<As...>> : __AllocatingCall<sizeof...(Ps) == sizeof...(As), argpack<Ps...>, argpack<As...>> {};
+
+		// The elements of a tuple, with the value category that decomposing cases receive them in
+		template<class T>
+		struct __Elements {
+			using type = argpack<>;
+		};
+
+		template<class... Ts>
+		struct __Elements<std::tuple<Ts...>> {
+			using type = argpack<Ts&&...>;
+		};
+
+		template<class... Ts>
+		struct __Elements<std::tuple<Ts...>&> {
+			using type = argpack<Ts&...>;
+		};
+
+		template<class... Ts>
+		struct __Elements<const std::tuple<Ts...>&> {
+			using type = argpack<const Ts&...>;
+		};
+
+		template<class... Ts>
+		struct __Elements<std::tuple<Ts...>&&> : __Elements<std::tuple<Ts...>> {};
+
+		template<bool, class Fn, class Arg>
+		struct __AllocatingCase : std::false_type {};								// Values (and other cases that aren't called) never convert
+
+		template<class Fn, class Arg>
+		struct __AllocatingCase<true, Fn, Arg>
+			: bool_t<__AllocatingArgs<typename function_traits<Fn>::arg_types, argpack<Arg>>::value
+			|| __AllocatingArgs<typename function_traits<Fn>::arg_types, typename __Elements<Arg>::type>::value> {};
+
+		// Stands in for a case that allocates so the resolver passes over it
+		template<class Fn>
+		struct __Allocates {};
+
+		template<class Arg, class Fn>
+		using __Cheap = std::conditional_t<__AllocatingCase<callable<Fn>::value, Fn, Arg>::value, __Allocates<Fn>, Fn>;
+
+		// Raise the error for NoAllocResolver (the instantiation lists the cases that would allocate)
+		template<class Arg, class... Fns>
+		using __AllocatingCases = decltype(std::tuple_cat(std::declval<std::conditional_t<__AllocatingCase<callable<Fns>::value, Fns, Arg>::value, std::tuple<Fns>, std::tuple<>>>()...));
+
+		template<class Arg, class Allocating>
+		struct __RejectAllocations;
+
+		template<class Arg, class... Allocating>
+		struct __RejectAllocations<Arg, std::tuple<Allocating...>> {
+			static_assert(sizeof...(Allocating) == 0, "Only cases that convert the value into a temporary that allocates take it (they're listed in `Allocating`)");
+			static constexpr bool value = sizeof...(Allocating) == 0;
 		};
 
 
@@ -128,62 +1186,568 @@ namespace shl {
 		using res = impl::__DefaultResolverImpl<0, 1, Arg, Fns...>;
 
 		public:
-			static constexpr auto value = impl::takes_args<callable<res::type>::value, res::type, shl::decay_t<Arg>>::value ? res::value : NOT_FOUND;
+			static constexpr auto value = impl::takes_args<callable<typename res::type>::value, typename res::type, Arg>::value ? res::value : NOT_FOUND;
+	};
+
+	/*
+	 * Resolver that produces the same result as DefaultResolver (including taking the first of two equal cases),
+	 *	but reduces the case list pairwise instead of walking it one case at a time. Use for large case lists where
+	 *	DefaultResolver's O(N) instantiation depth hits compiler limits
+	 *
+	 * Note: The two only differ when the best case is ambiguous (ie. when StrictResolver would reject the list)
+	 */
+	RES_DEF TournamentResolver {
+		using res = impl::__TournamentImpl<Arg, impl::__Bracket<std::index_sequence_for<Fns...>, Fns...>, 0, sizeof...(Fns)>;
+
+		public:
+			static constexpr auto value = impl::takes_args<callable<typename res::type>::value, typename res::type, Arg>::value ? res::value : NOT_FOUND;
 	};
 
 	/*
 	* Alternate struct to determine function match ordering under the C++ standard. This resolver more closely
 	*  mirrors compiler behavior in that it stops compilation if an ambiguous match resolution is found.
 	*
-	* Implementation follows the problem of first appearance in DefaultResolver:
-	*  If reversing the order of the function list, gives a different result from DefaultResolver
-	*  Then the result depended on the exact ordering of the list and therefore the resolution is ambiguous
+	* Implementation checks the case chosen by DefaultResolver against every other case in a single pass:
+	*  If any other case isn't strictly worse than the chosen one, then the chosen case only won because it came first
+	*  and therefore the resolution is ambiguous. Values that no case takes aren't checked (they go on to the fallbacks)
 	*/
 	RES_DEF StrictResolver : public DefaultResolver<Arg, Fns...>{
-		using reverse = impl::ReverseResolver<shl::DefaultResolver, Arg, typename reverse<Fns...>::type>;
+		static_assert(DefaultResolver<Arg, Fns...>::value == NOT_FOUND || impl::__Unambiguous<Arg, impl::__DefaultResolverImpl<0, 1, Arg, Fns...>, std::index_sequence_for<Fns...>, Fns...>::value,
+			"An ambiguous match case was found with shl::impl::StrictResolver");
+	};
 
-		static_assert(value == reverse::value, "An ambiguous match case was found with shl::impl::StrictResolver");
+
+	// Policies for the cases that convert the value into a temporary that allocates (see impl::__AllocatingCase)
+	struct allocations_last {};			// They're only picked when no other case takes the value
+	struct reject_allocations {};		// Picking one is a compile error (listing every case that would allocate)
+
+	/*
+	 * Resolver that mirrors DefaultResolver but keeps hidden allocations out of the match. Cases that would convert the value into
+	 *	an allocating temporary (ie. `const char*` into `const std::string&`) are passed over for any other case that takes the value,
+	 *	even a worse one. The Policy decides what happens when they're the only ones that do
+	 */
+	template<class Policy, class Arg, class... Fns>
+	class AllocAware {
+		static constexpr size_t cheap = DefaultResolver<Arg, impl::__Cheap<Arg, Fns>...>::value;
+
+		public:
+			static constexpr size_t value = (cheap != NOT_FOUND) ? cheap : DefaultResolver<Arg, Fns...>::value;
+
+			static_assert(std::conditional_t<std::is_same<Policy, reject_allocations>::value && cheap == NOT_FOUND && value != NOT_FOUND,
+				impl::__RejectAllocations<Arg, impl::__AllocatingCases<Arg, Fns...>>, std::true_type>::value, "A case that allocates was found with shl::NoAllocResolver");
 	};
 
+	RES_DEF AllocAwareResolver : public AllocAware<allocations_last, Arg, Fns...> {};
+	RES_DEF NoAllocResolver : public AllocAware<reject_allocations, Arg, Fns...> {};
+
+
+	// Tag for `match_all` and `match_each` to call the cases in the range's order instead of grouping the elements by case
+	struct in_order_t {};
+	inline constexpr in_order_t in_order{};
+
 
 	/*
 	 * Handles execution of match statement by selecting a function from a list based on argument type matching.
 	 *	Matcher doesn't destroy it's function list when matching against a passed value allowing it to be reused
 	 *	multiple times if desired without errors.
 	 */
-	template<RES_CLASS Resolver, class... Fns>
+	template<RES_CLASS Resolver, class Policy, class R, class... Fns>
 	class Matcher {
 		private:
+			using probe = impl::__Probe<Policy, Matcher, sizeof...(Fns)>;
+
 			std::tuple<Fns...> fns;
 
+			// Resolve and call the case for a single value (guards are tested first)
+			template<class T>
+			static constexpr R dispatch(std::tuple<Fns...>& fns, T&& val) {
+				if constexpr (impl::__GuardTable<std::remove_reference_t<T>, Fns...>::slots.size() != 0)
+					return dispatch_guard<0, T>(fns, std::forward<T>(val));
+				else
+					return dispatch_value(fns, std::forward<T>(val));
+			}
+
+			// Resolve and call the case for a value no guard holds for (integral and enum values try the value patterns first)
+			template<class T>
+			static constexpr R dispatch_value(std::tuple<Fns...>& fns, T&& val) {
+				if constexpr (impl::__Patterned<std::decay_t<T>, Fns...>::value)
+					return dispatch_pattern(fns, std::forward<T>(val));
+				else if constexpr (impl::__StringPatterned<std::decay_t<T>, Fns...>::value)
+					return dispatch_string(fns, std::forward<T>(val));
+				else
+					return dispatch_type(fns, std::forward<T>(val));
+			}
+
+			// Resolve and call the case for the type of a value
 			template<class T>
-			void match_impl(T&& val) {
+			static constexpr R dispatch_type(std::tuple<Fns...>& fns, T&& val) {
 				using namespace impl;
 
 				// Find the index of the base case function 
 				constexpr auto base_index = __IndexOf<bool, true, 0, base_case<Fns>::value...>::value;
 
-				// Attempt to find a function according to the given resolver
-				constexpr auto index = (Resolver<T, Fns...>::value == NOT_FOUND) ? base_index : Resolver<T, Fns...>::value;
+				// Attempt to find a function according to the given resolver, then one that takes the value's elements
+				constexpr auto decomposed = __DecomposedCase<Resolver<T, Fns...>::value == size_t(NOT_FOUND) && __TupleView<std::decay_t<T>>::value && !__StdTuple<std::decay_t<T>>::value, Resolver, T, Fns...>::value;
+				constexpr auto index = (Resolver<T, Fns...>::value != size_t(NOT_FOUND)) ? Resolver<T, Fns...>::value : (decomposed != size_t(NOT_FOUND)) ? decomposed : base_index;
 
 				// Raise compiler errors if no function was found or if the match contains 18,446,744,073,709,551,615 cases (-1 is used for NOT_FOUND)
 				static_assert(sizeof...(Fns) != std::numeric_limits<size_t>::max(), "Match statement contains too many cases. Please consider refactoring");
 				static_assert(sizeof...(Fns) > index, "Non-exhaustive pattern match found. Resolver did not find a valid match in the case list");
 
 				// Call the choosen function
-				__MatchHelper::nice_invoke<index>(fns, std::forward<T>(val));									// Hide compiler errors from `std::get` when index >= sizeof...(Fns)
+				[[maybe_unused]] typename probe::template scope<index> profiled{};
+				return __MatchHelper::nice_invoke<index, R>(fns, std::forward<T>(val));									// Hide compiler errors from `std::get` when index >= sizeof...(Fns)
+			}
+
+			template<size_t I, class T>
+			static constexpr R dispatch_case(std::tuple<Fns...>& fns, T&& val) {
+				[[maybe_unused]] typename probe::template scope<I> profiled{};
+				return impl::__MatchHelper::pattern_invoke<I, R>(fns, std::forward<T>(val));
+			}
+
+			template<size_t I, class T>
+			static constexpr auto case_thunk(std::true_type) -> R(*)(std::tuple<Fns...>&, T&&) { return &dispatch_case<I, T>; }
+
+			template<size_t I, class T>
+			static constexpr auto case_thunk(std::false_type) -> R(*)(std::tuple<Fns...>&, T&&) { return nullptr; }
+
+			// The case of every pattern case (null for the other cases)
+			template<class T, size_t... Is>
+			static constexpr std::array<R(*)(std::tuple<Fns...>&, T&&), sizeof...(Fns)> pattern_cases(std::index_sequence<Is...>) {
+				return { { case_thunk<Is, T>(impl::__IsPatternCase<Fns>{})... } };
+			}
+
+			// Jump table from every value the patterns span to its case (or to the cases for the value's type)
+			template<class T>
+			static constexpr auto pattern_jumps() {
+				using table = impl::__PatternTable<std::decay_t<T>, Fns...>;
+				using thunk = R(*)(std::tuple<Fns...>&, T&&);
+
+				constexpr auto cases = pattern_cases<T>(std::index_sequence_for<Fns...>{});
+				constexpr auto first = static_cast<unsigned long long>(table::intervals.front().lo);
+				std::array<thunk, table::span> jumps{};
+
+				for (auto& jump : jumps)
+					jump = &dispatch_type<T>;
+				for (auto& interval : table::intervals)
+					for (auto k = static_cast<unsigned long long>(interval.lo) - first; k <= static_cast<unsigned long long>(interval.hi) - first; ++k)
+						jumps[k] = cases[interval.fn];
+
+				return jumps;
+			}
+
+			// The tables for values of type T (constexpr functions can't hold them as local statics)
+			template<class T>
+			static constexpr auto pattern_jump_table = pattern_jumps<T>();
+
+			template<class T>
+			static constexpr auto pattern_case_table = pattern_cases<T>(std::index_sequence_for<Fns...>{});
+
+			// Look the value up in the patterns (a jump table when they're dense, a binary search otherwise)
+			template<class T>
+			static constexpr R dispatch_pattern(std::tuple<Fns...>& fns, T&& val) {
+				using key = impl::__PatternKey_t<std::decay_t<T>>;
+				using table = impl::__PatternTable<std::decay_t<T>, Fns...>;
+
+				static_assert(table::disjoint, "Value patterns overlap");
+				auto k = static_cast<key>(val);
+
+				if constexpr (table::dense) {
+					constexpr auto& jumps = pattern_jump_table<T>;
+					auto offset = static_cast<unsigned long long>(k) - static_cast<unsigned long long>(table::intervals.front().lo);
+
+					return offset < jumps.size() ? jumps[offset](fns, std::forward<T>(val)) : dispatch_type(fns, std::forward<T>(val));
+				}
+				else {
+					constexpr auto& cases = pattern_case_table<T>;
+					auto fn = table::find(k);
+
+					return fn != size_t(NOT_FOUND) ? cases[fn](fns, std::forward<T>(val)) : dispatch_type(fns, std::forward<T>(val));
+				}
+			}
+
+			template<size_t I, class T>
+			static constexpr bool guard_test(std::tuple<Fns...>& fns, std::remove_reference_t<T>& val) {
+				return std::get<I>(fns).pattern.pred(val);
+			}
+
+			// The test and the case of every guard for values of type T
+			template<class T, size_t... Gs>
+			static constexpr auto guard_cases(std::index_sequence<Gs...>) {
+				using table = impl::__GuardTable<std::remove_reference_t<T>, Fns...>;
+				using test = bool(*)(std::tuple<Fns...>&, std::remove_reference_t<T>&);
+				using call = R(*)(std::tuple<Fns...>&, T&&);
+
+				return std::make_pair(std::array<test, sizeof...(Gs)>{ { &guard_test<table::slots[Gs].fn, T>... } },
+					std::array<call, sizeof...(Gs)>{ { &dispatch_case<table::slots[Gs].fn, T>... } });
+			}
+
+			template<class T>
+			static auto guard_order() -> impl::__GuardOrder<impl::__GuardTable<std::remove_reference_t<T>, Fns...>::slots.size()>& {
+				static thread_local impl::__GuardOrder<impl::__GuardTable<std::remove_reference_t<T>, Fns...>::slots.size()> tested;
+				return tested;
+			}
+
+			/*
+			 * Test the guards from the G'th on
+			 *	A commutative run first tests the guards that held most often in this thread (through pointers to their tests), then
+			 *	the rest of its guards in written order. Every other guard is tested in place, so guards that don't commute never
+			 *	touch the thread's counters
+			 */
+			template<size_t G, class T>
+			static R dispatch_guard(std::tuple<Fns...>& fns, T&& val) {
+				using table = impl::__GuardTable<std::remove_reference_t<T>, Fns...>;
+
+				if constexpr (G == table::slots.size()) {
+					return dispatch_value(fns, std::forward<T>(val));
+				}
+				else {
+					constexpr auto slot = table::slots[G];
+
+					if constexpr (slot.end - slot.run > 1) {
+						constexpr auto hot = std::min(slot.run + impl::__HotGuards, slot.end);
+						static constexpr auto cases = guard_cases<T>(std::make_index_sequence<table::slots.size()>{});
+						auto& tested = guard_order<T>();
+
+						if constexpr (G == slot.run)
+							for (auto i = slot.run; i != hot; ++i) {
+								auto g = tested.order[i];
+								if (cases.first[g](fns, val)) {
+									tested.hit(i, slot.run);
+									return cases.second[g](fns, std::forward<T>(val));
+								}
+							}
+
+						if (tested.rank[G] >= hot && guard_test<slot.fn, T>(fns, val)) {
+							tested.hit(tested.rank[G], slot.run);
+							return dispatch_case<slot.fn, T>(fns, std::forward<T>(val));
+						}
+					}
+					else if (guard_test<slot.fn, T>(fns, val)) {
+						return dispatch_case<slot.fn, T>(fns, std::forward<T>(val));
+					}
+
+					return dispatch_guard<G + 1, T>(fns, std::forward<T>(val));
+				}
+			}
+
+			// Compare a string against the string patterns of length L from the I'th case on
+			template<size_t L, size_t I, class T>
+			static constexpr R dispatch_length(std::tuple<Fns...>& fns, T&& val, std::string_view text) {
+				if constexpr (I == sizeof...(Fns)) {
+					return dispatch_type(fns, std::forward<T>(val));
+				}
+				else {
+					if constexpr (impl::__StringLength<std::tuple_element_t<I, std::tuple<Fns...>>>::value == L)
+						if (L == 0 || std::char_traits<char>::compare(text.data(), std::get<I>(fns).pattern.text, L) == 0)
+							return dispatch_case<I, T>(fns, std::forward<T>(val));
+
+					return dispatch_length<L, I + 1, T>(fns, std::forward<T>(val), text);
+				}
+			}
+
+			template<class T>
+			static constexpr R dispatch_unmatched(std::tuple<Fns...>& fns, T&& val, std::string_view) {
+				return dispatch_type(fns, std::forward<T>(val));
+			}
+
+			// Jump table from a string's length to the comparisons against the patterns of that length
+			template<class T, size_t... Ls>
+			static constexpr std::array<R(*)(std::tuple<Fns...>&, T&&, std::string_view), sizeof...(Ls)> length_jumps(std::index_sequence<Ls...>) {
+				return { { (impl::__HasString<Ls, Fns...>::value ? &dispatch_length<Ls, 0, T> : &dispatch_unmatched<T>)... } };
+			}
+
+			template<class T>
+			static constexpr auto length_jump_table = length_jumps<T>(std::make_index_sequence<impl::__LongestString<Fns...>::value + 1>{});
+
+			template<class T>
+			static constexpr R dispatch_string(std::tuple<Fns...>& fns, T&& val) {
+				constexpr auto& jumps = length_jump_table<T>;
+
+				if constexpr (std::is_pointer<std::decay_t<T>>::value) {
+					if (val == nullptr) return dispatch_type(fns, std::forward<T>(val));
+				}
+
+				std::string_view text{ val };
+				return text.size() < jumps.size() ? jumps[text.size()](fns, std::forward<T>(val), text) : dispatch_type(fns, std::forward<T>(val));
+			}
+
+			// Call the case resolved for the I'th alternative of a sum type
+			template<size_t I, class V>
+			static constexpr R dispatch_alternative(std::tuple<Fns...>& fns, V&& val) {
+				return dispatch(fns, impl::__SumType<std::decay_t<V>>::template get<I>(std::forward<V>(val)));
+			}
+
+			// Compare the index against each alternative in turn (the last one is taken without a compare)
+			template<size_t I, class V>
+			static constexpr R dispatch_branch(std::tuple<Fns...>& fns, V&& val, size_t index) {
+				if constexpr (I + 1 == impl::__SumType<std::decay_t<V>>::size)
+					return dispatch_alternative<I, V>(fns, std::forward<V>(val));
+				else if (index == I)
+					return dispatch_alternative<I, V>(fns, std::forward<V>(val));
+				else
+					return dispatch_branch<I + 1, V>(fns, std::forward<V>(val), index);
+			}
+
+			/*
+			 * Resolve every alternative of a sum type at compile time and jump straight to the active alternative's case
+			 *	Sums of up to 4 alternatives branch instead, so the cases can be inlined (an indirect call costs more than a few compares)
+			 */
+			template<class V, size_t... Is>
+			static constexpr R dispatch_sum(std::tuple<Fns...>& fns, V&& val, std::index_sequence<Is...>) {
+				if constexpr (sizeof...(Is) <= 4) {
+					return dispatch_branch<0, V>(fns, std::forward<V>(val), impl::__SumType<std::decay_t<V>>::index(val));
+				}
+				else {
+					using thunk = R(*)(std::tuple<Fns...>&, V&&);
+					using table = impl::__JumpTable<thunk, &dispatch_alternative<Is, V>...>;
+
+					return table::value[impl::__SumType<std::decay_t<V>>::index(val)](fns, std::forward<V>(val));
+				}
+			}
+
+			// Call the case resolved for the combination of alternatives in cell K (the values are matched as a tuple of references to the alternatives)
+			template<size_t K, class Args>
+			static constexpr R dispatch_cell(std::tuple<Fns...>& fns, Args& args) {
+				return dispatch_cell<K>(fns, args, std::make_index_sequence<std::tuple_size<Args>::value>{});
+			}
+
+			template<size_t K, class Args, size_t... Js>
+			static constexpr R dispatch_cell(std::tuple<Fns...>& fns, Args& args, std::index_sequence<Js...>) {
+				using grid = impl::__DispatchGrid<Args>;
+				return dispatch(fns, std::forward_as_tuple(impl::__DispatchArg<std::tuple_element_t<Js, Args>>::template get<grid::coordinate(K, Js)>(std::get<Js>(std::move(args)))...));
+			}
+
+			// Resolve every combination of the values' alternatives at compile time and jump straight to the active combination's case
+				// The combinations share one flat table, so it's a single indirect call no matter how many values are sum types
+			template<class Args, size_t... Ks>
+			static constexpr R dispatch_cells(std::tuple<Fns...>& fns, Args& args, std::index_sequence<Ks...>) {
+				if constexpr (sizeof...(Ks) == 1) {
+					return dispatch_cell<0>(fns, args);
+				}
+				else {
+					using thunk = R(*)(std::tuple<Fns...>&, Args&);
+					using table = impl::__JumpTable<thunk, &dispatch_cell<Ks, Args>...>;
+
+					return table::value[std::apply(impl::__DispatchGrid<Args>::cell, args)](fns, args);
+				}
+			}
+
+			// Call the case resolved for the type stored in a `std::any` (U is the stored type)
+			template<class U, class V>
+			static R dispatch_held(std::tuple<Fns...>& fns, V&& val) {
+				return dispatch(fns, static_cast<impl::__ForwardLike_t<V, std::remove_pointer_t<decltype(std::any_cast<U>(&val))>>>(*std::any_cast<U>(&val)));
+			}
+
+			template<class U, class V>
+			static auto held_thunk(std::true_type) -> R(*)(std::tuple<Fns...>&, V&&) { return &dispatch_held<U, V>; }
+
+			template<class U, class V>
+			static auto held_thunk(std::false_type) -> R(*)(std::tuple<Fns...>&, V&&) { return nullptr; }
+
+			// Fall back to a case taking the `std::any` itself (or the base case) when the held type has no case
+			template<class V>
+			static R dispatch_unheld(std::tuple<Fns...>& fns, V&& val, std::true_type) {
+				return dispatch(fns, std::forward<V>(val));
+			}
+
+			template<class V>
+			static R dispatch_unheld(std::tuple<Fns...>&, V&&, std::false_type) {
+				throw std::bad_any_cast{};
+			}
+
+			template<class V>
+			static R dispatch_any(std::tuple<Fns...>& fns, V&& val) {
+				using namespace impl;
+				using thunk = R(*)(std::tuple<Fns...>&, V&&);
+
+				// Built on first use, candidates without a storable type (void) are skipped
+				static const __AnyTable<thunk, sizeof...(Fns)> table{
+					{ __TypeId<typename __AnyCaseType<Fns>::type>(), held_thunk<typename __AnyCaseType<Fns>::type, V>(bool_t<!std::is_void<typename __AnyCaseType<Fns>::type>::value>{}) }...
+				};
+
+				constexpr bool fallback = Resolver<V, Fns...>::value != size_t(NOT_FOUND) || __IndexOf<bool, true, 0, base_case<Fns>::value...>::value != size_t(NOT_FOUND);
+
+				if (auto held = table.find(val.type()))
+					return held(fns, std::forward<V>(val));
+				else
+					return dispatch_unheld(fns, std::forward<V>(val), bool_t<fallback>{});
+			}
+
+			template<class T>
+			constexpr R match_impl(T&& val, impl::__ValueDispatch) {
+				return dispatch(fns, std::forward<T>(val));
+			}
+
+			template<class T>
+			constexpr R match_impl(T&& val, impl::__SumDispatch) {
+				return dispatch_sum(fns, std::forward<T>(val), std::make_index_sequence<impl::__SumType<std::decay_t<T>>::size>{});
+			}
+
+			template<class T>
+			R match_impl(T&& val, impl::__AnyDispatch) {
+				return dispatch_any(fns, std::forward<T>(val));
+			}
+
+			template<class... Ts>
+			constexpr R match_impl(impl::__Args<Ts...> args, impl::__MultipleDispatch) {
+				return dispatch_cells(fns, args.refs, std::make_index_sequence<impl::__DispatchGrid<std::tuple<Ts&&...>>::cells>{});
+			}
+
+			template<class T>
+			constexpr R match_impl(T&& val) {
+				return match_impl(std::forward<T>(val), impl::__DispatchFor<Resolver, T, Fns...>{});
+			}
+
+			// The dispatch functions take the cases by reference, a const Matcher only lends them out when none can change through it
+			constexpr Matcher& as_mutable() const {
+				static_assert((impl::__ConstCase<Fns>::value && ...), "A const Matcher can only call cases that are callable through const (ie. lambdas that aren't `mutable`)");
+				return const_cast<Matcher&>(*this);
+			}
+
+			// Match the elements of a range in the range's order
+			template<class Range, class Tag>
+			void match_range(Range&& range, Tag) {
+				for (auto&& val : range)
+					match_impl(std::forward<decltype(val)>(val));
+			}
+
+			// Group the elements of a range of sum types by alternative and run each alternative's (compile time resolved) case over its group
+				// The grouping is a stable counting sort of pointers to the elements, so each group keeps the range's order
+			template<class Range>
+			void match_range(Range&& range, impl::__SumDispatch) {
+				match_grouped(range, std::make_index_sequence<impl::__SumType<std::decay_t<decltype(*std::begin(range))>>::size>{});
+			}
+
+			// Column stores are already grouped, so each column is a straight loop over a single (compile time resolved) case
+			template<class Range>
+			void match_range(Range&& range, impl::__ColumnDispatch) {
+				std::apply([this](auto&... columns) { (match_range(columns, impl::__ValueDispatch{}), ...); }, range.columns());
+			}
+
+			template<class Range, size_t... Is>
+			void match_grouped(Range& range, std::index_sequence<Is...>) {
+				using ref = decltype(*std::begin(range));
+				using sum = impl::__SumType<std::decay_t<ref>>;
+
+				std::array<size_t, sizeof...(Is) + 1> offsets{};
+				for (auto&& val : range)
+					++offsets[sum::index(val) + 1];
+				for (size_t i = 1; i != offsets.size(); ++i)
+					offsets[i] += offsets[i - 1];
+
+				std::vector<std::remove_reference_t<ref>*> grouped(offsets.back());
+				auto next = offsets;
+				for (auto&& val : range)
+					grouped[next[sum::index(val)]++] = std::addressof(val);
+
+				(dispatch_group<Is, ref>(grouped.data() + offsets[Is], grouped.data() + offsets[Is + 1]), ...);
+			}
+
+			template<size_t I, class V, class P>
+			void dispatch_group(P* const* first, P* const* last) {
+				for (; first != last; ++first)
+					dispatch_alternative<I>(fns, static_cast<V>(**first));
 			}
 
 		public:
-			Matcher(std::tuple<Fns...>&& fns) : fns{ fns } {}
+			constexpr Matcher(std::tuple<Fns...>&& fns) : fns{ std::move(fns) } {}
+
+			// Construct every case in place from the given arguments (each case is moved or copied exactly once)
+			template<class... Args>
+			constexpr Matcher(impl::__InPlaceCases, Args&&... args) : fns{ std::forward<Args>(args)... } {}
+
+			template<class T> constexpr R operator()(T&& val) { return match_impl(std::forward<T>(val)); }
+			template<class T> constexpr R match(T&& val) { return match_impl(std::forward<T>(val)); }
+
+			/*
+			 * Match through a const Matcher, ie. a `constexpr` one in a constant expression (needs every case to be callable through const)
+			 *	Values, sum types, tuples, value and string patterns and several values at once all match at compile time.
+			 *	Guards (their order is counted per thread), `std::any` and profiled Matchers only match at runtime
+			 */
+			template<class T> constexpr R operator()(T&& val) const { return as_mutable().match_impl(std::forward<T>(val)); }
+			template<class T> constexpr R match(T&& val) const { return as_mutable().match_impl(std::forward<T>(val)); }
+
+			/*
+			 * Match several values at once (multiple dispatch)
+			 *	Each case's parameters are ranked against the values one by one, like a call with several arguments. When some
+			 *	of the values are sum types, the case for every combination of their alternatives is resolved at compile time
+			 */
+			template<class T0, class T1, class... Ts>
+			constexpr R operator()(T0&& v0, T1&& v1, Ts&&... vs) {
+				return match_impl(impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) });
+			}
+
+			template<class T0, class T1, class... Ts>
+			constexpr R match(T0&& v0, T1&& v1, Ts&&... vs) {
+				return match_impl(impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) });
+			}
+
+			template<class T0, class T1, class... Ts>
+			constexpr R operator()(T0&& v0, T1&& v1, Ts&&... vs) const {
+				return as_mutable().match_impl(impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) });
+			}
 
-			template<class T> void operator()(T&& val) { return match_impl(std::forward<T>(val)); }
-			template<class T> void match(T&& val) { return match_impl(std::forward<T>(val)); }
+			template<class T0, class T1, class... Ts>
+			constexpr R match(T0&& v0, T1&& v1, Ts&&... vs) const {
+				return as_mutable().match_impl(impl::__Args<T0, T1, Ts...>{ std::forward_as_tuple(std::forward<T0>(v0), std::forward<T1>(v1), std::forward<Ts>(vs)...) });
+			}
+
+			/*
+			 * Match every element of a (multi-pass) range, discarding the results
+			 *	Ranges of sum types (`std::variant`, closed hierarchies) are grouped by alternative first so that each case runs over
+			 *	all of its elements back to back, instead of branching on every element. Column stores (`adt_vector`) are matched one
+			 *	column at a time without looking at their tags. Pass `shl::in_order` to keep the range's order
+			 */
+			template<class Range>
+			void match_all(Range&& range) {
+				using ref = decltype(*std::begin(range));
+				using grouping = std::conditional_t<std::is_lvalue_reference<ref>::value, impl::__DispatchFor<Resolver, ref, Fns...>, impl::__ValueDispatch>;
+
+				match_range(range, std::conditional_t<impl::__ColumnStore<std::remove_reference_t<Range>>::value, impl::__ColumnDispatch, grouping>{});
+			}
+
+			template<class Range>
+			void match_all(Range&& range, in_order_t) {
+				match_range(range, impl::__ValueDispatch{});
+			}
+
+			/*
+			 * Profile of every case, summed over all threads (only for Matchers built with a profiling policy)
+			 *	The counters belong to the Matcher's type, so they include every Matcher built by the same match expression
+			 */
+			std::vector<case_profile> profile() const {
+				static_assert(!std::is_same<Policy, no_profiling>::value, "Matcher is not profiled. Build it with `shl::count_cases` or `shl::time_cases`");
+				return probe::stats().profile({ { impl::__CaseLabel<Fns>::name()... } });
+			}
+
+			// Print one line per case (hits, time spent and signature) and flag the cases that were never called
+			template<class Stream>
+			void report(Stream& out) const {
+				for (auto& c : profile()) {
+					out << "case " << c.index << ": " << c.hits << " hits";
+					if (std::is_same<Policy, time_cases>::value)
+						out << ", " << c.time.count() << " ns";
+
+					out << "  " << c.signature << (c.hits ? "\n" : "  <- never called\n");
+				}
+			}
 	};
 
 	// Pass the value on to the provided matcher object for match resolution
-	template<RES_CLASS Resolver, class T, class... Args>
-	void match(T&& val, Matcher<Resolver, Args...>& matcher) {
-		matcher.match(std::forward<T>(val));
+	template<RES_CLASS Resolver, class Policy, class R, class T, class... Args>
+	R match(T&& val, Matcher<Resolver, Policy, R, Args...>& matcher) {
+		return matcher.match(std::forward<T>(val));
+	}
+
+	// Match every element of the range with the provided matcher (grouped by alternative, or in the range's order with `shl::in_order`)
+	template<RES_CLASS Resolver, class Policy, class R, class Range, class... Args>
+	void match_each(Range&& range, Matcher<Resolver, Policy, R, Args...>& matcher) {
+		matcher.match_all(std::forward<Range>(range));
+	}
+
+	template<RES_CLASS Resolver, class Policy, class R, class Range, class... Args>
+	void match_each(Range&& range, Matcher<Resolver, Policy, R, Args...>& matcher, in_order_t) {
+		matcher.match_all(std::forward<Range>(range), in_order);
 	}
 }
\ No newline at end of file
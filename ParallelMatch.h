@@ -0,0 +1,299 @@
+#pragma once
+#ifdef _MSC_VER
+#pragma warning (disable:4814)				// Disable the c++14 warning about "constexpr not implying const"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Matcher.h"
+
+namespace shl {
+
+	/*
+	 * Persistent pool of worker threads that `par_match` spreads a range across
+	 *	The calling thread always works as worker 0, so a pool of size N starts N - 1 threads
+	 *	Jobs are run one at a time (concurrent `par_match` calls on the same pool queue up), so a case must not call
+	 *	`par_match` on the pool that's running it
+	 */
+	class MatchPool {
+		private:
+			std::vector<std::thread> threads;
+			std::mutex run_lock;								// Held for the duration of a job
+
+			std::mutex lock;
+			std::condition_variable wake, done;
+			std::function<void(size_t)> job;
+			size_t generation = 0;
+			size_t pending = 0;
+			bool stopping = false;
+
+			void work(size_t worker) {
+				size_t seen = 0;
+
+				while (true) {
+					std::unique_lock<std::mutex> guard{ lock };
+					wake.wait(guard, [&] { return stopping || generation != seen; });
+					if (stopping) return;
+
+					seen = generation;
+					guard.unlock();
+
+					job(worker);
+
+					guard.lock();
+					if (--pending == 0) done.notify_one();
+				}
+			}
+
+		public:
+			explicit MatchPool(size_t workers = std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+				for (size_t i = 1; i < workers; ++i)
+					threads.emplace_back([this, i] { work(i); });
+			}
+
+			~MatchPool() {
+				{
+					std::lock_guard<std::mutex> guard{ lock };
+					stopping = true;
+				}
+
+				wake.notify_all();
+				for (auto& thread : threads) thread.join();
+			}
+
+			// Number of workers (including the calling thread)
+			size_t size() const { return threads.size() + 1; }
+
+			// Call `fn(worker)` once on every worker and wait for all of them to return (`fn` must not throw)
+			template<class F>
+			void run(F&& fn) {
+				std::lock_guard<std::mutex> running{ run_lock };
+
+				{
+					std::lock_guard<std::mutex> guard{ lock };
+					job = std::ref(fn);
+					pending = threads.size();
+					++generation;
+				}
+
+				wake.notify_all();
+				fn(size_t{ 0 });
+
+				std::unique_lock<std::mutex> guard{ lock };
+				done.wait(guard, [&] { return pending == 0; });
+				job = nullptr;
+			}
+
+			MatchPool(const MatchPool&) = delete;
+			MatchPool& operator=(const MatchPool&) = delete;
+	};
+
+	namespace impl {
+
+		// Pool used when `par_match` isn't given one (sized to the hardware and started on first use)
+		inline MatchPool& __DefaultPool() {
+			static MatchPool pool;
+			return pool;
+		}
+
+		// Cases with no state of their own (empty function objects, function pointers and values) can be shared between workers
+		template<class Fn>
+		struct __StatelessCase : bool_t<std::is_empty<Fn>::value || std::is_pointer<Fn>::value || !callable<Fn>::value> {};
+
+		template<class P, class F>
+		struct __StatelessCase<__PatternCase<P, F>> : __StatelessCase<F> {};
+
+		template<class Pred, bool C, class F>
+		struct __StatelessCase<__PatternCase<when_t<Pred, C>, F>> : bool_t<__StatelessCase<Pred>::value && __StatelessCase<F>::value> {};
+
+		template<class... Fns>
+		struct __Stateless : all<std::true_type, __StatelessCase<Fns>...> {};
+
+		template<>
+		struct __Stateless<> : std::true_type {};
+
+		// Iterator pair that can be handed to `Matcher::match_all`
+		template<class It>
+		struct __Span {
+			It first, last;
+
+			It begin() const { return first; }
+			It end() const { return last; }
+		};
+
+		/*
+		 * Index ranges owned by each worker, which they take chunks from the front of and steal from the back of
+		 *	A worker takes 1/8 of what's left of its own range (at least `grain` elements) so chunks start large enough to make
+		 *	locking negligible and shrink as the range runs out. Once its own range is empty, it steals the back half of the
+		 *	fullest range left, until there's nothing left anywhere (work is never added, so that's the end of the job)
+		 */
+		class __StealingRanges {
+			private:
+				struct alignas(64) __Range {
+					std::mutex lock;
+					size_t lo = 0, hi = 0;
+				};
+
+				std::vector<__Range> ranges;
+				size_t grain;
+
+				bool steal(size_t worker) {
+					while (true) {
+						size_t victim = worker, most = 0;
+
+						for (size_t i = 0; i != ranges.size(); ++i) {
+							std::lock_guard<std::mutex> guard{ ranges[i].lock };
+							if (ranges[i].hi - ranges[i].lo > most) {
+								victim = i;
+								most = ranges[i].hi - ranges[i].lo;
+							}
+						}
+
+						if (most == 0) return false;
+
+						size_t lo, hi;
+						{
+							std::lock_guard<std::mutex> guard{ ranges[victim].lock };
+							auto left = ranges[victim].hi - ranges[victim].lo;
+							if (left == 0) continue;								// Drained while we were looking, try again
+
+							hi = ranges[victim].hi;
+							lo = hi - (left + 1) / 2;
+							ranges[victim].hi = lo;
+						}
+
+						std::lock_guard<std::mutex> guard{ ranges[worker].lock };
+						ranges[worker].lo = lo;
+						ranges[worker].hi = hi;
+						return true;
+					}
+				}
+
+			public:
+				__StealingRanges(size_t size, size_t workers, size_t grain) : ranges(workers), grain{ std::max<size_t>(grain, 1) } {
+					for (size_t i = 0; i != workers; ++i) {
+						ranges[i].lo = size * i / workers;
+						ranges[i].hi = size * (i + 1) / workers;
+					}
+				}
+
+				// Claim the next chunk for the worker, returns false when every range is empty
+				bool next(size_t worker, size_t& lo, size_t& hi) {
+					{
+						std::lock_guard<std::mutex> guard{ ranges[worker].lock };
+						auto left = ranges[worker].hi - ranges[worker].lo;
+
+						if (left != 0) {
+							lo = ranges[worker].lo;
+							hi = lo + std::min(left, std::max(left / 8, grain));
+							ranges[worker].lo = hi;
+							return true;
+						}
+					}
+
+					return steal(worker) && next(worker, lo, hi);
+				}
+		};
+
+		/*
+		 * Run `chunk(worker, matcher, lo, hi)` over the chunks of [0, size) on every worker of the pool
+		 *	Each worker matches with its own copy of the matcher unless all of its cases are stateless
+		 *	The first exception thrown by a case stops the other workers at their next chunk and is rethrown to the caller
+		 */
+		template<class M, class Chunk>
+		void __ParallelChunks(M& matcher, size_t size, size_t grain, MatchPool& pool, Chunk&& chunk, std::true_type) {
+			__StealingRanges ranges{ size, pool.size(), grain };
+			std::atomic<bool> failed{ false };
+			std::exception_ptr error;
+
+			pool.run([&](size_t worker) {
+				try {
+					size_t lo, hi;
+					while (!failed.load(std::memory_order_relaxed) && ranges.next(worker, lo, hi))
+						chunk(worker, matcher, lo, hi);
+				}
+				catch (...) {
+					if (!failed.exchange(true)) error = std::current_exception();
+				}
+			});
+
+			if (error) std::rethrow_exception(error);
+		}
+
+		template<class M, class Chunk>
+		void __ParallelChunks(M& matcher, size_t size, size_t grain, MatchPool& pool, Chunk&& chunk, std::false_type) {
+			__StealingRanges ranges{ size, pool.size(), grain };
+			std::atomic<bool> failed{ false };
+			std::exception_ptr error;
+
+			pool.run([&](size_t worker) {
+				try {
+					M local = matcher;
+					size_t lo, hi;
+					while (!failed.load(std::memory_order_relaxed) && ranges.next(worker, lo, hi))
+						chunk(worker, local, lo, hi);
+				}
+				catch (...) {
+					if (!failed.exchange(true)) error = std::current_exception();
+				}
+			});
+
+			if (error) std::rethrow_exception(error);
+		}
+	}
+
+	/*
+	 * Match every element of a random access range across the workers of a pool, discarding the results
+	 *	Each chunk goes through `Matcher::match_all`, so ranges of sum types are still grouped by alternative within a chunk
+	 *	NOTE: Worker copies only protect the cases' own state, anything a case captures by reference is still shared
+	 */
+	template<class Range, RES_CLASS Resolver, class Policy, class R, class... Fns>
+	void par_match(Range&& range, Matcher<Resolver, Policy, R, Fns...>& matcher, MatchPool& pool = impl::__DefaultPool(), size_t grain = 256) {
+		using iterator = decltype(std::begin(range));
+		static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<iterator>::iterator_category>::value, "par_match requires a random access range");
+
+		auto first = std::begin(range);
+		auto size = static_cast<size_t>(std::end(range) - first);
+
+		impl::__ParallelChunks(matcher, size, grain, pool, [first](size_t, auto& m, size_t lo, size_t hi) {
+			m.match_all(impl::__Span<iterator>{ first + lo, first + hi });
+		}, impl::__Stateless<Fns...>{});
+	}
+
+	/*
+	 * Match every element of a random access range across the workers of a pool and reduce the results
+	 *	Every worker folds its results into its own accumulator (starting from `init`) and the accumulators are reduced in worker order
+	 *	at the end, so `reduce` must be associative and commutative (chunks can be stolen) and `init` has to be its identity
+	 */
+	template<class Range, RES_CLASS Resolver, class Policy, class R, class... Fns, class T, class Reduce>
+	std::enable_if_t<std::is_invocable<Reduce&, T, R>::value, T> par_match(Range&& range, Matcher<Resolver, Policy, R, Fns...>& matcher, T init, Reduce reduce, MatchPool& pool = impl::__DefaultPool(), size_t grain = 256) {
+		using iterator = decltype(std::begin(range));
+		static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<iterator>::iterator_category>::value, "par_match requires a random access range");
+		static_assert(!std::is_void<R>::value, "par_match can only reduce the results of a matcher whose cases return values");
+
+		auto first = std::begin(range);
+		auto size = static_cast<size_t>(std::end(range) - first);
+		std::vector<T> partial(pool.size(), init);
+
+		impl::__ParallelChunks(matcher, size, grain, pool, [&](size_t worker, auto& m, size_t lo, size_t hi) {
+			auto acc = std::move(partial[worker]);
+			for (auto i = lo; i != hi; ++i)
+				acc = reduce(std::move(acc), m.match(first[i]));
+
+			partial[worker] = std::move(acc);
+		}, impl::__Stateless<Fns...>{});
+
+		for (auto& acc : partial)
+			init = reduce(std::move(init), std::move(acc));
+
+		return init;
+	}
+}
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+Clean build benchmark for the ways a translation unit can pull in the library
+
+Generates --units translation units that match values of common types (fundamental types,
+`const char*`, `std::string`, `std::string_view`) and compiles every one of them to an object
+file (-c) in each mode:
+
+	headers   - `#include "MatchResolver.h"` in every unit (the baseline)
+	pch       - MatchPrecompiled.h built once into a precompiled header, with its pre-instantiated
+	            conversion ranks, and force-included into every unit
+	module    - MatchModule.cppm built once into the `shl.match` module and imported by every unit
+	            (needs -std=c++20 and a compiler with working modules)
+
+and reports the one-off setup time, the time spent on the units and the total against the
+headers mode. A mode that fails to build is reported as FAILED with the compiler's last error.
+
+	python3 bench/build_bench.py                              # table on stdout
+	python3 bench/build_bench.py --units 300 --modes headers pch
+	python3 bench/build_bench.py --json build.json            # save results
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from compile_bench import ROOT, compiler_kind, run_compiler
+
+MODES = ("headers", "pch", "module")
+TYPES = ("int", "long", "double", "bool", "unsigned", "const char*", "std::string")
+
+
+def generate(mode, unit):
+	"""Produce a translation unit that resolves a few matches over the common types"""
+	if mode == "module":
+		lines = ["import shl.match;", "#include <string>", "#include <string_view>"]
+	elif mode == "pch":
+		lines = []
+	else:
+		lines = ['#include "MatchResolver.h"', "#include <string>", "#include <string_view>"]
+
+	params = ("int", "long", "double", "bool", "const std::string&", "std::string_view", "const char*")
+	lines += ["", "int unit_{0}({1}) {{".format(unit, ", ".join("{0} v{1}".format(t, i) for i, t in enumerate(TYPES))), "\tint r = 0;"]
+
+	# Every value is matched against a rotation of the parameters, so units differ from each other
+	for i in range(len(TYPES)):
+		cases = [params[(i + unit + k) % len(params)] for k in range(4)]
+		arms = ["[]({0}) {{ return {1}; }}".format(p, k) for k, p in enumerate(cases)]
+		lines.append("\tr += shl::match(v{0}) | {1} || [] {{ return -1; }};".format(i, " | ".join(arms)))
+
+	lines.append("\tauto m = shl::match() | " + " | ".join("[]({0}) {{ return {1}; }}".format(p, k) for k, p in enumerate(params[:-1])) + " || [] { return -1; };")
+	lines.append("\treturn r + " + " + ".join("m(v{0})".format(i) for i in range(len(TYPES))) + ";")
+	lines.append("}")
+	return "\n".join(lines) + "\n"
+
+
+def setup(args, kind, mode, work):
+	"""Build the mode's shared artifact, returning (seconds, ok, error, extra flags for the units)"""
+	if mode == "headers":
+		return 0.0, True, "", []
+
+	if mode == "pch":
+		header = os.path.join(work, "MatchPrecompiled.h")
+		shutil.copy(os.path.join(ROOT, "MatchPrecompiled.h"), header)
+		if kind == "clang":
+			pch = header + ".pch"
+			cmd = [args.cxx, "-std=" + args.std, "-O" + args.opt, "-I", ROOT, "-x", "c++-header", header, "-o", pch] + args.flag
+			flags = ["-include-pch", pch]
+		else:
+			cmd = [args.cxx, "-std=" + args.std, "-O" + args.opt, "-I", ROOT, "-x", "c++-header", header, "-o", header + ".gch"] + args.flag
+			flags = ["-include", header]
+
+	else:
+		if kind == "clang":
+			pcm = os.path.join(work, "shl.match.pcm")
+			cmd = [args.cxx, "-std=" + args.std, "-O" + args.opt, "-I", ROOT, "-x", "c++-module", os.path.join(ROOT, "MatchModule.cppm"), "--precompile", "-o", pcm] + args.flag
+			flags = ["-fmodule-file=shl.match=" + pcm]
+		else:
+			cmd = [args.cxx, "-std=" + args.std, "-O" + args.opt, "-fmodules-ts", "-I", ROOT, "-x", "c++", os.path.join(ROOT, "MatchModule.cppm"), "-c", "-o", os.path.join(work, "module.o")] + args.flag
+			flags = ["-fmodules-ts"]
+
+	elapsed, _, ok, err = run_compiler(cmd, work, args.timeout)
+	return elapsed, ok, err, flags
+
+
+def measure(args, kind, mode):
+	with tempfile.TemporaryDirectory(prefix="shl_build_") as work:
+		result = {"mode": mode, "units": args.units, "setup": 0.0, "compile": 0.0, "ok": True, "error": ""}
+
+		elapsed, ok, err, flags = setup(args, kind, mode, work)
+		result.update(setup=elapsed, ok=ok, error=err[-4000:])
+		if not ok:
+			return result
+
+		for unit in range(args.units):
+			src = os.path.join(work, "unit_{0}.cpp".format(unit))
+			with open(src, "w") as f:
+				f.write(generate(mode, unit))
+
+			cmd = [args.cxx, "-std=" + args.std, "-O" + args.opt, "-I", ROOT] + flags + ["-c", src, "-o", src + ".o"] + args.flag
+			elapsed, _, ok, err = run_compiler(cmd, work, args.timeout)
+			result["compile"] += elapsed
+			if not ok:
+				result.update(ok=False, error=err[-4000:])
+				break
+
+		return result
+
+
+def report(results):
+	baseline = next((r for r in results if r["mode"] == "headers" and r["ok"]), None)
+
+	header = "{:<8} {:>6} {:>9} {:>11} {:>11} {:>10}".format("mode", "units", "setup(s)", "units(s)", "total(s)", "vs headers")
+	print(header)
+	print("-" * len(header))
+
+	for r in results:
+		if not r["ok"]:
+			line = "{:<8} {:>6} {:>9}".format(r["mode"], r["units"], "FAILED")
+			print(line + "  " + r["error"].strip().splitlines()[-1][:120] if r["error"].strip() else line)
+			continue
+
+		total = r["setup"] + r["compile"]
+		versus = "n/a"
+		if baseline:
+			old = baseline["setup"] + baseline["compile"]
+			versus = "{:+.0f}%".format(100.0 * (total - old) / old)
+
+		print("{:<8} {:>6} {:>9.2f} {:>11.2f} {:>11.2f} {:>10}".format(r["mode"], r["units"], r["setup"], r["compile"], total, versus))
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+	parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"), help="compiler to benchmark (default: $CXX or c++)")
+	parser.add_argument("--std", default="c++20", help="language standard passed as -std= (modules need c++20)")
+	parser.add_argument("--opt", default="0", help="optimization level passed as -O")
+	parser.add_argument("--units", type=int, default=16, help="translation units to compile per mode")
+	parser.add_argument("--modes", nargs="+", default=list(MODES), choices=MODES)
+	parser.add_argument("--timeout", type=int, default=600, help="per-compile timeout in seconds")
+	parser.add_argument("--flag", action="append", default=[], help="extra compiler flag (repeatable)")
+	parser.add_argument("--json", help="write the results to this file")
+	parser.add_argument("--emit", help="only write the generated sources into this directory")
+	args = parser.parse_args()
+
+	if args.emit:
+		os.makedirs(args.emit, exist_ok=True)
+		for mode in args.modes:
+			for unit in range(args.units):
+				with open(os.path.join(args.emit, "{}_{}.cpp".format(mode, unit)), "w") as f:
+					f.write(generate(mode, unit))
+		return
+
+	kind = compiler_kind(args.cxx)
+	results = []
+	for mode in args.modes:
+		print("building {0} / {1} units ...".format(mode, args.units), file=sys.stderr)
+		results.append(measure(args, kind, mode))
+
+	report(results)
+
+	if args.json:
+		with open(args.json, "w") as f:
+			json.dump({"compiler": args.cxx, "std": args.std, "results": results}, f, indent=1)
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""
+Compile-time scaling benchmark for shl::match case lists
+
+Generates translation units that build `shl::match() | ... || ...` Matcher chains and
+`shl::match(val) | ... || ...` MatchResolver chains with a growing number of cases and
+reports, for every combination of form, resolver and case count:
+
+	* wall-clock compile time (best of --repeat runs)
+	* peak compiler memory (max RSS of the compiler process)
+	* template instantiation counts for the resolver metaprograms
+
+Instantiation counts are taken from `-fdump-lang-class` when compiling with gcc and from
+`-ftime-trace` when compiling with clang. Other compilers only report time and memory.
+
+	python3 bench/compile_bench.py                          # table on stdout
+	python3 bench/compile_bench.py --json before.json       # save results
+	python3 bench/compile_bench.py --compare before.json    # diff against saved results
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+FORMS = ("builder", "resolver")
+RESOLVERS = ("DefaultResolver", "StrictResolver", "TournamentResolver")
+SIZES = (8, 32, 128, 512)
+TRACKED = ("__DefaultResolverImpl", "__TournamentImpl", "StrictResolver", "takes_args")
+
+
+def generate(form, resolver, cases):
+	"""Produce a translation unit with `cases` distinct cases"""
+	lines = [
+		"// Generated by bench/compile_bench.py",
+		'#include "MatchResolver.h"',
+		"",
+		"template<int> struct tag {};",
+		"",
+		"int main() {",
+	]
+
+	# Resolve against the first, middle and last case so every resolver walks the whole list
+	probes = sorted({0, cases // 2, cases - 1})
+	arms = ["\t\t| [](tag<{0}>) {{}}".format(i) for i in range(cases - 1)] + ["\t\t|| [](tag<{0}>) {{}};".format(cases - 1)]
+
+	if form == "builder":
+		lines.append("\tauto m = shl::match<shl::{0}>()".format(resolver))
+		lines += arms
+		lines += ["\tm(tag<{0}>{{}});".format(p) for p in probes]
+	else:
+		for p in probes:
+			lines.append("\tshl::match<shl::{0}>(tag<{1}>{{}})".format(resolver, p))
+			lines += arms
+
+	lines.append("}")
+	return "\n".join(lines) + "\n"
+
+
+def count_instantiations(compiler, workdir):
+	"""Count the tracked class template instantiations from the compiler's dumps"""
+	counts = dict.fromkeys(TRACKED, 0)
+
+	if compiler == "gcc":
+		for dump in glob.glob(os.path.join(workdir, "*.class")):
+			with open(dump, errors="replace") as f:
+				for line in f:
+					if not line.startswith("Class "):
+						continue
+					name = line[6:].split("<", 1)[0]
+					for t in TRACKED:
+						if name.endswith(t):
+							counts[t] += 1
+
+	elif compiler == "clang":
+		for trace in glob.glob(os.path.join(workdir, "*.json")):
+			with open(trace) as f:
+				events = json.load(f).get("traceEvents", [])
+			for e in events:
+				if e.get("name") != "InstantiateClass":
+					continue
+				name = e.get("args", {}).get("detail", "").split("<", 1)[0]
+				for t in TRACKED:
+					if name.endswith(t):
+						counts[t] += 1
+
+	else:
+		return None
+
+	return counts
+
+
+def compiler_kind(cxx):
+	out = subprocess.run([cxx, "--version"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True).stdout
+	if "clang" in out:
+		return "clang"
+	if "GCC" in out or "g++" in out or "Free Software Foundation" in out:
+		return "gcc"
+	return "other"
+
+
+def run_compiler(cmd, cwd, timeout):
+	"""Run the compiler, returning (seconds, peak rss in KiB, ok, stderr)"""
+	start = time.perf_counter()
+	proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+
+	try:
+		_, err = proc.communicate(timeout=timeout)
+	except subprocess.TimeoutExpired:
+		proc.kill()
+		proc.communicate()
+		return timeout, 0, False, "timed out"
+
+	elapsed = time.perf_counter() - start
+	rss = 0
+	try:
+		import resource
+		rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+	except ImportError:
+		pass
+
+	return elapsed, rss, proc.returncode == 0, err
+
+
+def measure(args, kind, form, resolver, cases):
+	with tempfile.TemporaryDirectory(prefix="shl_bench_") as work:
+		src = os.path.join(work, "case.cpp")
+		with open(src, "w") as f:
+			f.write(generate(form, resolver, cases))
+
+		cmd = [args.cxx, "-std=" + args.std, "-O0", "-fsyntax-only", "-I", ROOT, src] + args.flag
+		if kind in ("gcc", "clang"):
+			cmd += ["-ftemplate-depth=" + str(args.depth)]
+
+		best = None
+		for _ in range(args.repeat):
+			# Peak rss is reported per process, so measure each run in its own child
+			r = subprocess.run([sys.executable, __file__, "--run-one", json.dumps([cmd, work, args.timeout])],
+							   stdout=subprocess.PIPE, universal_newlines=True)
+			res = json.loads(r.stdout)
+			if best is None or res["time"] < best["time"]:
+				best = res
+			if not res["ok"]:
+				break
+
+		# Instantiation counts need a separate, instrumented compile
+		counts = None
+		if best["ok"] and kind == "gcc":
+			subprocess.run(cmd + ["-fdump-lang-class", "-dumpdir", work + os.sep], cwd=work,
+						   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, timeout=args.timeout)
+			counts = count_instantiations(kind, work)
+		elif best["ok"] and kind == "clang":
+			obj = os.path.join(work, "case.o")
+			trace = [c for c in cmd if c != "-fsyntax-only"] + ["-c", "-o", obj, "-ftime-trace", "-ftime-trace-granularity=0"]
+			subprocess.run(trace, cwd=work, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, timeout=args.timeout)
+			counts = count_instantiations(kind, work)
+
+		best.update(form=form, resolver=resolver, cases=cases, counts=counts)
+		return best
+
+
+def report(results, baseline):
+	keyed = {}
+	if baseline:
+		keyed = {(r["form"], r["resolver"], r["cases"]): r for r in baseline["results"]}
+
+	header = "{:<9} {:<19} {:>5} {:>9} {:>10}".format("form", "resolver", "cases", "time(s)", "rss(MiB)")
+	header += "".join(" {:>21}".format(t) for t in TRACKED)
+	print(header)
+	print("-" * len(header))
+
+	def delta(new, old, fmt):
+		if old is None or old == 0:
+			return fmt.format(new)
+		return fmt.format(new) + " ({:+.0f}%)".format(100.0 * (new - old) / old)
+
+	for r in results:
+		old = keyed.get((r["form"], r["resolver"], r["cases"]))
+		if not r["ok"]:
+			line = "{:<9} {:<19} {:>5} {:>9}".format(r["form"], r["resolver"], r["cases"], "FAILED")
+			print(line + "  " + r["error"].strip().splitlines()[-1][:120] if r["error"].strip() else line)
+			continue
+
+		line = "{:<9} {:<19} {:>5} {:>9} {:>10}".format(
+			r["form"], r["resolver"], r["cases"],
+			delta(r["time"], old and old["time"], "{:.2f}"),
+			delta(r["rss"] / 1024.0, old and old["rss"] / 1024.0, "{:.0f}"))
+
+		for t in TRACKED:
+			if r["counts"] is None:
+				line += " {:>21}".format("n/a")
+			else:
+				prev = old and old["counts"] and old["counts"].get(t)
+				line += " {:>21}".format(delta(r["counts"][t], prev, "{}"))
+		print(line)
+
+
+def main():
+	if len(sys.argv) == 3 and sys.argv[1] == "--run-one":
+		cmd, cwd, timeout = json.loads(sys.argv[2])
+		elapsed, rss, ok, err = run_compiler(cmd, cwd, timeout)
+		print(json.dumps({"time": elapsed, "rss": rss, "ok": ok, "error": err[-4000:]}))
+		return
+
+	parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+	parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"), help="compiler to benchmark (default: $CXX or c++)")
+	parser.add_argument("--std", default="c++17", help="language standard passed as -std=")
+	parser.add_argument("--sizes", type=int, nargs="+", default=list(SIZES), help="case counts to generate")
+	parser.add_argument("--forms", nargs="+", default=list(FORMS), choices=FORMS)
+	parser.add_argument("--resolvers", nargs="+", default=list(RESOLVERS), help="resolver class templates in namespace shl")
+	parser.add_argument("--repeat", type=int, default=3, help="compile each unit this many times and keep the fastest")
+	parser.add_argument("--depth", type=int, default=4096, help="template instantiation depth limit")
+	parser.add_argument("--timeout", type=int, default=600, help="per-compile timeout in seconds")
+	parser.add_argument("--flag", action="append", default=[], help="extra compiler flag (repeatable)")
+	parser.add_argument("--json", help="write the results to this file")
+	parser.add_argument("--compare", help="show relative change against a previous --json file")
+	parser.add_argument("--emit", help="only write the generated sources into this directory")
+	args = parser.parse_args()
+
+	if args.emit:
+		os.makedirs(args.emit, exist_ok=True)
+		for form in args.forms:
+			for res in args.resolvers:
+				for n in args.sizes:
+					with open(os.path.join(args.emit, "{}_{}_{}.cpp".format(form, res, n)), "w") as f:
+						f.write(generate(form, res, n))
+		return
+
+	kind = compiler_kind(args.cxx)
+	baseline = None
+	if args.compare:
+		with open(args.compare) as f:
+			baseline = json.load(f)
+
+	results = []
+	for form in args.forms:
+		for res in args.resolvers:
+			for n in args.sizes:
+				print("compiling {} / {} / {} cases ...".format(form, res, n), file=sys.stderr)
+				results.append(measure(args, kind, form, res, n))
+
+	report(results, baseline)
+
+	if args.json:
+		with open(args.json, "w") as f:
+			json.dump({"compiler": args.cxx, "kind": kind, "std": args.std, "results": results}, f, indent=1)
+
+
+if __name__ == "__main__":
+	main()
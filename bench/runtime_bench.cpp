@@ -0,0 +1,749 @@
+/*
+ * Runtime dispatch microbenchmark for shl::match
+ *
+ *	Times the path through `Matcher::match_impl`, `__MatchHelper::nice_invoke` and the `std::apply` tuple
+ *	decomposition against `std::visit`, a virtual-call hierarchy and a hand-written `switch` chain running
+ *	the same workloads. Reports ns/op, instructions/op (Linux perf counters, when available), heap
+ *	allocations/op and copies/op of a counted payload.
+ *
+ *	Build and run from the repository root:
+ *		c++ -std=c++17 -O2 -pthread -I. bench/runtime_bench.cpp -o runtime_bench && ./runtime_bench
+ *
+ *	Pass a workload name (int, promote, string, cstring, tuple, payload, variant, pair, opcode, method, guards, option, batch, parallel, mailbox, tree, any, record) to only run that workload
+ */
+
+#include <any>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "ADT.h"
+#include "ADTRecursive.h"
+#include "ADTVector.h"
+#include "Mailbox.h"
+#include "MatchResolver.h"
+#include "ParallelMatch.h"
+
+
+/*
+ * Global counters for allocations and payload copies (reset around every measurement)
+ */
+static std::size_t allocations = 0;
+static std::size_t copies = 0;
+
+void* operator new(std::size_t size) {
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Payload that records every copy made of it (moves are free)
+struct Payload {
+	long long value;
+
+	Payload(long long v) : value{ v } {}
+	Payload(const Payload& p) : value{ p.value } { ++copies; }
+	Payload(Payload&&) = default;
+	Payload& operator=(const Payload& p) { value = p.value; ++copies; return *this; }
+	Payload& operator=(Payload&&) = default;
+};
+
+// Aggregate with the same layout as the record tuple
+struct Record {
+	int id;
+	Payload payload;
+};
+
+
+/*
+ * Measurement helpers
+ */
+
+// Prevent the compiler from discarding or hoisting a computed value
+template<class T>
+inline void keep(T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : "+m"(val) : : "memory");
+#else
+	static volatile T* sink;
+	sink = &val;
+#endif
+}
+
+// Retired instruction counter (returns false if perf events aren't available, ie. in containers)
+class InstructionCounter {
+	private:
+		int fd = -1;
+
+	public:
+		InstructionCounter() {
+#ifdef __linux__
+			perf_event_attr attr{};
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+		}
+		~InstructionCounter() {
+#ifdef __linux__
+			if (fd >= 0) close(fd);
+#endif
+		}
+
+		bool available() const { return fd >= 0; }
+
+		void start() {
+#ifdef __linux__
+			if (fd < 0) return;
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+		}
+
+		long long stop() {
+			long long count = 0;
+#ifdef __linux__
+			if (fd < 0) return 0;
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+			return count;
+		}
+};
+
+static InstructionCounter instructions;
+static const char* only = nullptr;
+static constexpr std::size_t ITERATIONS = 10000000;
+
+// Run `op` ITERATIONS times (after a warmup) and print a result row
+	// `op` handles `batch` elements per call for batch workloads, so every row is still reported per element
+template<class Op>
+void measure(const char* workload, const char* strategy, Op&& op, std::size_t batch = 1) {
+	if (only && std::strcmp(only, workload) != 0) return;
+
+	for (std::size_t i = 0; i != ITERATIONS / 10 / batch; ++i) op(i);
+
+	allocations = copies = 0;
+	instructions.start();
+	auto start = std::chrono::steady_clock::now();
+
+	for (std::size_t i = 0; i != ITERATIONS / batch; ++i) op(i);
+
+	auto end = std::chrono::steady_clock::now();
+	auto instr = instructions.stop();
+	auto allocs = allocations, copied = copies;
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+	std::printf("%-9s %-14s %9.3f ", workload, strategy, ns);
+	if (instructions.available())
+		std::printf("%12.2f ", double(instr) / ITERATIONS);
+	else
+		std::printf("%12s ", "n/a");
+	std::printf("%10.3f %10.3f\n", double(allocs) / ITERATIONS, double(copied) / ITERATIONS);
+}
+
+
+/*
+ * Competing dispatch mechanisms
+ */
+using Message = std::variant<int, long, std::string, const char*, std::tuple<int, const char*>, Payload>;
+
+struct Node {
+	virtual ~Node() = default;
+	virtual void accept(long long& sum) const = 0;
+};
+
+struct IntNode : Node {
+	int val;
+	IntNode(int v) : val{ v } {}
+	void accept(long long& sum) const override { sum += val; }
+};
+
+struct StringNode : Node {
+	std::string val;
+	StringNode(std::string v) : val{ std::move(v) } {}
+	void accept(long long& sum) const override { sum += val.size(); }
+};
+
+struct CstringNode : Node {
+	const char* val;
+	CstringNode(const char* v) : val{ v } {}
+	void accept(long long& sum) const override { sum += *val; }
+};
+
+struct TupleNode : Node {
+	std::tuple<int, const char*> val;
+	TupleNode(std::tuple<int, const char*> v) : val{ v } {}
+	void accept(long long& sum) const override { sum += std::get<0>(val) + *std::get<1>(val); }
+};
+
+struct PayloadNode : Node {
+	Payload val;
+	PayloadNode(Payload v) : val{ std::move(v) } {}
+	void accept(long long& sum) const override { sum += val.value; }
+};
+
+enum class Kind { Int, String, Cstring, Tuple, Payload };
+
+struct Tagged {
+	Kind kind;
+	int i = 0;
+	const std::string* s = nullptr;
+	const char* c = nullptr;
+	const Payload* p = nullptr;
+};
+
+// Hand-written branch chain equivalent of the match cases below
+inline void dispatch(const Tagged& msg, long long& sum) {
+	switch (msg.kind) {
+		case Kind::Int: sum += msg.i; break;
+		case Kind::String: sum += msg.s->size(); break;
+		case Kind::Cstring: sum += *msg.c; break;
+		case Kind::Tuple: sum += msg.i + *msg.c; break;
+		case Kind::Payload: sum += msg.p->value; break;
+	}
+}
+
+// Guard that holds for one field name, chained 24 times to stand in for a validation matcher
+static std::string fields[32];
+
+template<int K>
+struct Equals {
+	bool operator()(std::string_view name) const { return name == fields[K]; }
+};
+
+template<int... Ks>
+auto ordered_guards(std::integer_sequence<int, Ks...>) {
+	return (shl::match() | ... | shl::when(Equals<Ks>{})(Ks)) || -1;
+}
+
+template<int... Ks>
+auto commutative_guards(std::integer_sequence<int, Ks...>) {
+	return (shl::match() | ... | shl::when(Equals<Ks>{}, shl::commutative)(Ks)) || -1;
+}
+
+
+// Expression tree with a `new` per node and a recursive evaluator
+struct HeapExpr {
+	enum { Num, Add, Neg } kind;
+	int value;
+	std::unique_ptr<HeapExpr> lhs, rhs;
+};
+
+long long eval(const HeapExpr& e) {
+	switch (e.kind) {
+		case HeapExpr::Num: return e.value;
+		case HeapExpr::Add: return eval(*e.lhs) + eval(*e.rhs);
+		default: return -eval(*e.lhs);
+	}
+}
+
+// The same tree as a recursive adt in an arena
+struct Expr;
+struct Num { int value; };
+struct Add { shl::rec<Expr> lhs, rhs; };
+struct Neg { shl::rec<Expr> arg; };
+struct Expr : shl::adt<Num, Add, Neg> { using adt::adt; };
+
+// Balanced tree of `n` nodes (mostly additions, with a negation wherever `n` is 2 or a multiple of 3)
+std::unique_ptr<HeapExpr> heap_tree(int n) {
+	if (n == 1) return std::unique_ptr<HeapExpr>{ new HeapExpr{ HeapExpr::Num, n, nullptr, nullptr } };
+	if (n == 2 || n % 3 == 0) return std::unique_ptr<HeapExpr>{ new HeapExpr{ HeapExpr::Neg, 0, heap_tree(n - 1), nullptr } };
+	return std::unique_ptr<HeapExpr>{ new HeapExpr{ HeapExpr::Add, 0, heap_tree((n - 1) / 2), heap_tree(n - 1 - (n - 1) / 2) } };
+}
+
+const Expr* arena_tree(shl::arena& nodes, int n) {
+	if (n == 1) return nodes.make<Expr>(Num{ n });
+	if (n == 2 || n % 3 == 0) return nodes.make<Expr>(Neg{ arena_tree(nodes, n - 1) });
+	return nodes.make<Expr>(Add{ arena_tree(nodes, (n - 1) / 2), arena_tree(nodes, n - 1 - (n - 1) / 2) });
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1) only = argv[1];
+
+	long long sum = 0;
+	auto str = std::string{ "a string long enough to avoid SSO" };
+	auto c_str = str.c_str();
+	auto tupl = std::make_tuple(3, c_str);
+	auto payload = Payload{ 7 };
+
+	// One reusable matcher covering every workload
+	auto m = shl::match()
+		| [&](int i) { sum += i; }
+		| [&](long l) { sum += l; }
+		| [&](const std::string& s) { sum += s.size(); }
+		| [&](const char* c) { sum += *c; }
+		| [&](int i, const char* c) { sum += i + *c; }
+		| [&](int i, const Payload& p) { sum += i + p.value; }
+		|| [&](const Payload& p) { sum += p.value; };
+
+	auto visitor = [&](const auto& v) {
+		using T = std::decay_t<decltype(v)>;
+		if constexpr (std::is_same_v<T, std::string>) sum += v.size();
+		else if constexpr (std::is_same_v<T, const char*>) sum += *v;
+		else if constexpr (std::is_same_v<T, std::tuple<int, const char*>>) sum += std::get<0>(v) + *std::get<1>(v);
+		else if constexpr (std::is_same_v<T, Payload>) sum += v.value;
+		else sum += v;
+	};
+
+	std::printf("%-9s %-14s %9s %12s %10s %10s\n", "workload", "strategy", "ns/op", "instr/op", "allocs/op", "copies/op");
+	std::printf("---------------------------------------------------------------------\n");
+
+	// int -> int
+	{
+		int val = 3;
+		Message var = val;
+		std::unique_ptr<Node> node = std::make_unique<IntNode>(val);
+		Tagged tag{ Kind::Int, val };
+
+		measure("int", "direct", [&](std::size_t) { keep(val); sum += val; });
+		measure("int", "Matcher", [&](std::size_t) { keep(val); m(val); });
+		measure("int", "MatchResolver", [&](std::size_t) {
+			keep(val);
+			shl::match(val)
+				| [&](int i) { sum += i; }
+				|| [&](long l) { sum += l; };
+		});
+		measure("int", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("int", "virtual", [&](std::size_t) { keep(node); node->accept(sum); });
+		measure("int", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// short -> int promotion
+	{
+		short val = 3;
+		Message var = int{ val };
+		Tagged tag{ Kind::Int, val };
+
+		measure("promote", "direct", [&](std::size_t) { keep(val); sum += int{ val }; });
+		measure("promote", "Matcher", [&](std::size_t) { keep(val); m(val); });
+		measure("promote", "MatchResolver", [&](std::size_t) {
+			keep(val);
+			shl::match(val)
+				| [&](int i) { sum += i; }
+				|| [&](long l) { sum += l; };
+		});
+		measure("promote", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("promote", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// std::string by const&
+	{
+		Message var = str;
+		std::unique_ptr<Node> node = std::make_unique<StringNode>(str);
+		Tagged tag{ Kind::String, 0, &str };
+
+		measure("string", "direct", [&](std::size_t) { keep(str); sum += str.size(); });
+		measure("string", "Matcher", [&](std::size_t) { keep(str); m(str); });
+		measure("string", "MatchResolver", [&](std::size_t) {
+			keep(str);
+			shl::match(str)
+				| [&](const char* c) { sum += *c; }
+				|| [&](const std::string& s) { sum += s.size(); };
+		});
+		measure("string", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("string", "virtual", [&](std::size_t) { keep(node); node->accept(sum); });
+		measure("string", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// const char* with a competing `const std::string&` case
+	{
+		Message var = c_str;
+		std::unique_ptr<Node> node = std::make_unique<CstringNode>(c_str);
+		Tagged tag{ Kind::Cstring, 0, nullptr, c_str };
+
+		measure("cstring", "direct", [&](std::size_t) { keep(c_str); sum += *c_str; });
+		measure("cstring", "Matcher", [&](std::size_t) { keep(c_str); m(c_str); });
+		measure("cstring", "MatchResolver", [&](std::size_t) {
+			keep(c_str);
+			shl::match(c_str)
+				| [&](const std::string& s) { sum += s.size(); }
+				|| [&](const char* c) { sum += *c; };
+		});
+		measure("cstring", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("cstring", "virtual", [&](std::size_t) { keep(node); node->accept(sum); });
+		measure("cstring", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// std::tuple<int, const char*> decomposed through std::apply
+	{
+		Message var = tupl;
+		std::unique_ptr<Node> node = std::make_unique<TupleNode>(tupl);
+		Tagged tag{ Kind::Tuple, 3, nullptr, c_str };
+
+		measure("tuple", "direct", [&](std::size_t) { keep(tupl); sum += std::get<0>(tupl) + *std::get<1>(tupl); });
+		measure("tuple", "Matcher", [&](std::size_t) { keep(tupl); m(tupl); });
+		measure("tuple", "MatchResolver", [&](std::size_t) {
+			keep(tupl);
+			shl::match(tupl)
+				| [&](int, std::string) { sum += 1; }
+				|| [&](int i, const char* c) { sum += i + *c; };
+		});
+		measure("tuple", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("tuple", "virtual", [&](std::size_t) { keep(node); node->accept(sum); });
+		measure("tuple", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// Counted payload by const& (any copy made on the way to the case shows up in copies/op)
+	{
+		Message var = payload;
+		std::unique_ptr<Node> node = std::make_unique<PayloadNode>(payload);
+		Tagged tag{ Kind::Payload, 0, nullptr, nullptr, &payload };
+
+		measure("payload", "direct", [&](std::size_t) { keep(payload); sum += payload.value; });
+		measure("payload", "Matcher", [&](std::size_t) { keep(payload); m(payload); });
+		measure("payload", "MatchResolver", [&](std::size_t) {
+			keep(payload);
+			shl::match(payload)
+				| [&](int i) { sum += i; }
+				|| [&](const Payload& p) { sum += p.value; };
+		});
+		measure("payload", "std::visit", [&](std::size_t) { keep(var); std::visit(visitor, var); });
+		measure("payload", "virtual", [&](std::size_t) { keep(node); node->accept(sum); });
+		measure("payload", "switch", [&](std::size_t) { keep(tag); dispatch(tag, sum); });
+	}
+
+	// Mixed std::variant stream (Matcher jumps through its per-alternative table)
+	{
+		std::vector<Message> msgs = { 3, 4L, str, c_str, tupl, payload };
+		std::vector<std::unique_ptr<Node>> nodes;
+		nodes.push_back(std::make_unique<IntNode>(3));
+		nodes.push_back(std::make_unique<IntNode>(4));
+		nodes.push_back(std::make_unique<StringNode>(str));
+		nodes.push_back(std::make_unique<CstringNode>(c_str));
+		nodes.push_back(std::make_unique<TupleNode>(tupl));
+		nodes.push_back(std::make_unique<PayloadNode>(payload));
+		std::vector<Tagged> tags = {
+			{ Kind::Int, 3 }, { Kind::Int, 4 }, { Kind::String, 0, &str }, { Kind::Cstring, 0, nullptr, c_str },
+			{ Kind::Tuple, 3, nullptr, c_str }, { Kind::Payload, 0, nullptr, nullptr, &payload }
+		};
+
+		measure("variant", "Matcher", [&](std::size_t i) { m(msgs[i % 6]); });
+		measure("variant", "std::visit", [&](std::size_t i) { std::visit(visitor, msgs[i % 6]); });
+		measure("variant", "virtual", [&](std::size_t i) { nodes[i % 6]->accept(sum); });
+		measure("variant", "switch", [&](std::size_t i) { dispatch(tags[i % 6], sum); });
+	}
+
+	// Pairs of std::variant values (Matcher resolves all 9 combinations into one flat table, nested std::visit branches twice)
+	{
+		using Operand = std::variant<int, long, const char*>;
+		std::vector<Operand> lhs = { 3, 4L, c_str, 5, c_str, 6L, 7 };
+		std::vector<Operand> rhs = { 4L, c_str, 3, 8, 9L };
+
+		auto pair = shl::match()
+			| [&](int a, int b) { sum += a + b; }
+			| [&](long a, long b) { sum += a * b; }
+			| [&](int a, long b) { sum += a - b; }
+			| [&](long a, int b) { sum += b - a; }
+			| [&](const char* a, const char* b) { sum += *a + *b; }
+			| [&](const char* a, long b) { sum += *a + b; }
+			|| [&] { ++sum; };
+		auto pair_visitor = [&](auto a, auto b) {
+			using A = decltype(a);
+			using B = decltype(b);
+			if constexpr (std::is_same<A, int>::value && std::is_same<B, int>::value) sum += a + b;
+			else if constexpr (std::is_same<A, long>::value && std::is_same<B, long>::value) sum += a * b;
+			else if constexpr (std::is_same<A, int>::value && std::is_same<B, long>::value) sum += a - b;
+			else if constexpr (std::is_same<A, long>::value && std::is_same<B, int>::value) sum += b - a;
+			else if constexpr (std::is_same<A, const char*>::value && std::is_same<B, const char*>::value) sum += *a + *b;
+			else if constexpr (std::is_same<A, const char*>::value && std::is_same<B, long>::value) sum += *a + b;
+			else ++sum;
+		};
+
+		measure("pair", "Matcher", [&](std::size_t i) { pair(lhs[i % 7], rhs[i % 5]); });
+		measure("pair", "std::visit", [&](std::size_t i) { std::visit(pair_visitor, lhs[i % 7], rhs[i % 5]); });
+		measure("pair", "nested visit", [&](std::size_t i) {
+			std::visit([&](auto a) { std::visit([&](auto b) { pair_visitor(a, b); }, rhs[i % 5]); }, lhs[i % 7]);
+		});
+	}
+
+	// Opcode stream (dense value patterns become a jump table, the sparse ones a binary search)
+	{
+		std::vector<int> ops;
+		std::uint32_t seed = 777;
+		for (std::size_t i = 0; i != 1024; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			ops.push_back(int(seed >> 28));
+		}
+
+		auto dense = shl::match()
+			| shl::val<0>([&] { sum += 1; })
+			| shl::val<1>([&] { sum -= 1; })
+			| shl::val<2, 3>([&](int op) { sum += op; })
+			| shl::range<4, 9>([&](int op) { sum ^= op; })
+			| shl::val<10>([&] { sum <<= 1; })
+			|| [&] { sum >>= 1; };
+		auto sparse = shl::match()
+			| shl::val<0>([&] { sum += 1; })
+			| shl::val<100>([&] { sum -= 1; })
+			| shl::val<2000, 3000>([&](int op) { sum += op; })
+			| shl::range<40000, 90000>([&](int op) { sum ^= op; })
+			|| [&] { sum >>= 1; };
+
+		measure("opcode", "Matcher", [&](std::size_t i) { dense(ops[i % 1024]); });
+		measure("opcode", "switch", [&](std::size_t i) {
+			auto op = ops[i % 1024];
+			switch (op) {
+				case 0: sum += 1; break;
+				case 1: sum -= 1; break;
+				case 2: case 3: sum += op; break;
+				case 4: case 5: case 6: case 7: case 8: case 9: sum ^= op; break;
+				case 10: sum <<= 1; break;
+				default: sum >>= 1; break;
+			}
+		});
+		measure("opcode", "sparse", [&](std::size_t i) { sparse(ops[i % 1024] * 1000); });
+	}
+
+	// HTTP methods (string patterns jump on the length and memcmp the patterns of that length, the chain compares every method in turn)
+	{
+		std::vector<std::string_view> methods = { "GET", "POST", "GET", "PUT", "DELETE", "HEAD", "GET", "OPTIONS", "PATCH", "BREW", "POST" };
+
+		auto method = shl::match()
+			| shl::str("GET")(1)
+			| shl::str("HEAD")(2)
+			| shl::str("POST")(3)
+			| shl::str("PUT")(4)
+			| shl::str("DELETE")(5)
+			| shl::str("OPTIONS")(6)
+			| shl::str("PATCH")(7)
+			|| 0;
+
+		measure("method", "Matcher", [&](std::size_t i) { sum += method(methods[i % 11]); });
+		measure("method", "if chain", [&](std::size_t i) {
+			auto m = methods[i % 11];
+			sum += m == "GET" ? 1 : m == "HEAD" ? 2 : m == "POST" ? 3 : m == "PUT" ? 4 : m == "DELETE" ? 5 : m == "OPTIONS" ? 6 : m == "PATCH" ? 7 : 0;
+		});
+	}
+
+	// Runtime guards (the common field name is tested last in written order, the commutative guards move it to the front)
+	{
+		for (int k = 0; k != 32; ++k)
+			fields[k] = "field_" + std::to_string(k);
+
+		std::vector<std::string_view> names;
+		std::uint32_t seed = 4242;
+		for (std::size_t i = 0; i != 1024; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			names.push_back(fields[(seed >> 24) < 230 ? 23 : seed >> 27]);
+		}
+
+		auto ordered = ordered_guards(std::make_integer_sequence<int, 24>{});
+		auto adaptive = commutative_guards(std::make_integer_sequence<int, 24>{});
+
+		measure("guards", "in order", [&](std::size_t i) { sum += ordered(names[i % 1024]); });
+		measure("guards", "adaptive", [&](std::size_t i) { sum += adaptive(names[i % 1024]); });
+	}
+
+	// Optional pointers (shl::option keeps "none" in a misaligned address and is pointer-sized, the std::variant needs a tag next to the pointer)
+	{
+		const Payload* none = nullptr;
+		std::vector<shl::option<const Payload*>> options;
+		std::vector<std::variant<std::monostate, const Payload*>> variants;
+		for (std::size_t i = 0; i != 64; ++i) {
+			options.push_back(i % 3 ? shl::option<const Payload*>{ &payload } : shl::option<const Payload*>{ shl::none });
+			variants.push_back(i % 3 ? decltype(variants)::value_type{ &payload } : decltype(variants)::value_type{});
+		}
+
+		auto opt = shl::match()
+			| [&](const Payload* p) { sum += p->value; }
+			|| [&](shl::none_t) { keep(none); };
+		auto opt_visitor = [&](auto v) {
+			if constexpr (std::is_same<decltype(v), std::monostate>::value) keep(none);
+			else sum += v->value;
+		};
+
+		if (!only || std::strcmp(only, "option") == 0)
+			std::printf("(%zu bytes per shl::option, %zu per std::variant)\n", sizeof(options[0]), sizeof(variants[0]));
+		measure("option", "Matcher", [&](std::size_t i) { opt(options[i % 64]); });
+		measure("option", "std::visit", [&](std::size_t i) { std::visit(opt_visitor, variants[i % 64]); });
+	}
+
+	// Shuffled batch of std::variant messages (match_all groups the batch by alternative before dispatching, adt_vector is already grouped)
+	{
+		constexpr std::size_t BATCH = 4096;
+		std::vector<Message> batch;
+		std::uint32_t seed = 12345;
+		for (std::size_t i = 0; i != BATCH; ++i) {
+			seed = seed * 1664525 + 1013904223;
+			switch (seed >> 29) {
+				case 0: batch.emplace_back(3); break;
+				case 1: batch.emplace_back(4L); break;
+				case 2: batch.emplace_back(str); break;
+				case 3: case 4: batch.emplace_back(c_str); break;
+				case 5: batch.emplace_back(tupl); break;
+				default: batch.emplace_back(payload); break;
+			}
+		}
+
+		measure("batch", "Matcher", [&](std::size_t) { for (auto& msg : batch) m(msg); }, BATCH);
+		measure("batch", "std::visit", [&](std::size_t) { for (auto& msg : batch) std::visit(visitor, msg); }, BATCH);
+		measure("batch", "match_all", [&](std::size_t) { m.match_all(batch); }, BATCH);
+		measure("batch", "in_order", [&](std::size_t) { m.match_all(batch, shl::in_order); }, BATCH);
+
+		// The same values stored one column per alternative
+		shl::adt_vector<int, long, std::string, const char*, std::tuple<int, const char*>, Payload> columns;
+		for (auto& msg : batch)
+			std::visit([&](const auto& v) { columns.push_back(v); }, msg);
+
+		measure("batch", "adt_vector", [&](std::size_t) { m.match_all(columns); }, BATCH);
+		measure("batch", "adt in_order", [&](std::size_t) { m.match_all(columns, shl::in_order); }, BATCH);
+	}
+
+	// Large std::variant range summed through value-returning cases (par_match spreads it over every hardware thread)
+	{
+		constexpr std::size_t RANGE = 1 << 20;
+		std::vector<Message> range;
+		for (std::size_t i = 0; i != RANGE; ++i)
+			range.push_back(i % 3 ? Message{ int(i) } : i % 2 ? Message{ str } : Message{ payload });
+
+		auto values = shl::match()
+			| [](int i) { return (long long)i; }
+			| [](long l) { return (long long)l; }
+			| [](const std::string& s) { return (long long)s.size(); }
+			| [](const char* c) { return (long long)*c; }
+			| [](int i, const char* c) { return (long long)(i + *c); }
+			|| [](const Payload& p) { return p.value; };
+
+		measure("parallel", "Matcher", [&](std::size_t) { for (auto& msg : range) sum += values(msg); }, RANGE);
+		measure("parallel", "par_match", [&](std::size_t) { sum += shl::par_match(range, values, 0LL, std::plus<>{}); }, RANGE);
+	}
+
+	// 32 producers posting to one consumer that matches every message (a mutex-protected std::deque against shl::mailbox)
+	{
+		constexpr std::size_t PRODUCERS = 32, MAILS = 1 << 18;
+		using Mail = std::variant<int, long, const char*>;
+
+		auto mails = shl::match()
+			| [&](int i) { sum += i; }
+			| [&](long l) { sum += l; }
+			|| [&](const char* c) { sum += *c; };
+
+		auto produce = [&](auto post) {
+			std::vector<std::thread> producers;
+			for (std::size_t p = 0; p != PRODUCERS; ++p)
+				producers.emplace_back([&, p, post] {
+					for (std::size_t i = p; i < MAILS; i += PRODUCERS)
+						i % 3 ? post(Mail{ int(i) }) : i % 2 ? post(Mail{ long(i) }) : post(Mail{ c_str });
+				});
+
+			return producers;
+		};
+
+		std::mutex lock;
+		std::condition_variable ready;
+		std::deque<Mail> queue;
+
+		measure("mailbox", "mutex deque", [&](std::size_t) {
+			auto producers = produce([&](Mail msg) {
+				{
+					std::lock_guard<std::mutex> guard{ lock };
+					queue.push_back(std::move(msg));
+				}
+				ready.notify_one();
+			});
+
+			for (std::size_t n = 0; n != MAILS; ++n) {
+				std::unique_lock<std::mutex> guard{ lock };
+				ready.wait(guard, [&] { return !queue.empty(); });
+				auto msg = std::move(queue.front());
+				queue.pop_front();
+				guard.unlock();
+				mails(msg);
+			}
+
+			for (auto& t : producers) t.join();
+		}, MAILS);
+
+		shl::mailbox<decltype(mails), int, long, const char*> box{ mails, 1 << 16 };
+
+		measure("mailbox", "shl::mailbox", [&](std::size_t) {
+			auto producers = produce([&](Mail msg) { box.post(std::move(msg)); });
+			for (std::size_t n = 0; n != MAILS; n += box.receive(256));
+			for (auto& t : producers) t.join();
+		}, MAILS);
+	}
+
+	// Expression trees built with a `new` per node against a monotonic arena, and evaluated recursively against shl::fold
+	{
+		constexpr int NODES = 1 << 16;
+
+		measure("tree", "new build", [&](std::size_t) { sum += heap_tree(NODES)->kind; }, NODES);
+		measure("tree", "arena build", [&](std::size_t) {
+			shl::arena nodes{ 1 << 16 };
+			sum += arena_tree(nodes, NODES)->index();
+		}, NODES);
+
+		auto heap = heap_tree(NODES);
+		shl::arena nodes;
+		auto tree = arena_tree(nodes, NODES);
+
+		auto evaluate = shl::match()
+			| [](const Num& n) { return (long long)n.value; }
+			| [](const Add&, long long lhs, long long rhs) { return lhs + rhs; }
+			|| [](const Neg&, long long arg) { return -arg; };
+
+		measure("tree", "recursive eval", [&](std::size_t) { sum += eval(*heap); }, NODES);
+		measure("tree", "fold", [&](std::size_t) { sum += shl::fold(tree, evaluate); }, NODES);
+	}
+
+	// std::any stream (Matcher looks the held type up in its typeid table, the ladder tries any_cast in order)
+	{
+		std::vector<std::any> anys = { 3, 4L, str, c_str, tupl, payload };
+
+		measure("any", "Matcher", [&](std::size_t i) { m(anys[i % 6]); });
+		measure("any", "any_cast", [&](std::size_t i) {
+			auto& a = anys[i % 6];
+			if (auto p = std::any_cast<int>(&a)) sum += *p;
+			else if (auto p = std::any_cast<long>(&a)) sum += *p;
+			else if (auto p = std::any_cast<std::string>(&a)) sum += p->size();
+			else if (auto p = std::any_cast<const char*>(&a)) sum += **p;
+			else if (auto p = std::any_cast<std::tuple<int, const char*>>(&a)) sum += std::get<0>(*p) + *std::get<1>(*p);
+			else if (auto p = std::any_cast<Payload>(&a)) sum += p->value;
+		});
+	}
+
+	// std::tuple<int, Payload> and the equivalent aggregate decomposed into (int, const Payload&) (copies/op shows copies of the elements)
+	{
+		auto record = std::make_tuple(3, payload);
+		auto aggregate = Record{ 3, payload };
+
+		measure("record", "direct", [&](std::size_t) { keep(record); sum += std::get<0>(record) + std::get<1>(record).value; });
+		measure("record", "Matcher", [&](std::size_t) { keep(record); m(record); });
+		measure("record", "MatchResolver", [&](std::size_t) {
+			keep(record);
+			shl::match(record)
+				| [&](int i) { sum += i; }
+				|| [&](int i, const Payload& p) { sum += i + p.value; };
+		});
+		measure("record", "aggregate", [&](std::size_t) { keep(aggregate); m(aggregate); });
+	}
+
+	std::printf("\n(checksum %lld)\n", sum);
+}
@@ -99,7 +99,7 @@ namespace shl {
 			using No = long;
 
 			template<class T> static constexpr Yes is(decltype(&std::decay_t<T>::operator()));
-			template<classT> static constexpr No is(...);
+			template<class T> static constexpr No is(...);
 
 		public:
 			static constexpr bool value = (sizeof(is<F>(nullptr)) == sizeof(Yes));
@@ -119,17 +119,11 @@ namespace shl {
 	 *	all: check that all types in Ts inherit from W (Note: W inherits from W)
 	 *	one: check that one type in Ts inherits from W
 	 */
-	template<class W, class T, class... Ts>
-	struct all : std::conditional_t<all<W, T>::value, all<W, Ts...>, std::false_type> {};
+	template<class W, class... Ts>
+	struct all : bool_t<(std::is_base_of<W, Ts>::value && ...)> {};
 
-	template<class W, class T>
-	struct all<W, T> : std::is_base_of<W, T> {};
-
-	template<class W, class T, class... Ts>
-	struct one : std::conditional_t<std::is_base_of<W, T>::value, std::true_type, one<W, Ts...>> {};
-
-	template<class W, class T>
-	struct one<W, T> : all<W, T> {};
+	template<class W, class... Ts>
+	struct one : bool_t<(std::is_base_of<W, Ts>::value || ...)> {};
 
 
 	// Use less than in templates
@@ -161,38 +155,68 @@ namespace shl {
 	 * Metastructs to determine the relative ordering of two parameters according to overload resolution rules
 	 */
 
-	// Test if F -> T is possible through user conversion operator
+	// Test if F -> T is possible through user conversion operator (or converting constructor)
+		// Conversions between non-class types and from a class to itself or one of its bases are standard conversions
 	template<class T, class F>
-	struct IsUserConvertable : std::false_type {};
+	struct IsUserConvertable {
+		private:
+			using to = std::remove_cv_t<std::remove_reference_t<T>>;
+			using from = std::remove_cv_t<std::remove_reference_t<F>>;
+
+		public:
+			static constexpr bool value = std::is_convertible<F, T>::value && (std::is_class<to>::value || std::is_class<from>::value)
+				&& !std::is_same<to, from>::value && !std::is_base_of<to, from>::value;
+	};
 
 	// Test if F -> T is possible through user conversion operator
 	template<class T, class F>
 	struct IsStdConvertable : std::is_convertible<F, T> {};
 
 	// Test if F -> T is a numeric promotion
+		// Integral and unscoped enum types promote to the type that unary `+` gives them (int for bool, char, short, etc.
+		// unsigned/long for wchar_t, char16_t and wide enums). Bit fields aren't visible in the type so they aren't considered
+	namespace impl {
+		template<class F, class T, class = void>
+		struct __IsPromotion : std::false_type {};
+
+		template<class F, class T>
+		struct __IsPromotion<F, T, std::enable_if_t<std::is_integral<F>::value || (std::is_enum<F>::value && std::is_convertible<F, int>::value)>>
+			: bool_t<!std::is_same<F, T>::value && std::is_same<decltype(+std::declval<F>()), T>::value> {};
+
+		template<> struct __IsPromotion<float, double> : std::true_type {};
+	}
+
 	template<class F, class T>
-	struct IsPromotion : std::false_type {};
-	template<> struct IsPromotion<float, double> : std::true_type {};
-	template<> struct IsPromotion<char, int> : std::true_type {};
-	template<> struct IsPromotion<short, int> : std::true_type {};
-	template<> struct IsPromotion<bool, int> : std::true_type {};
-	// TODO: Complete implementation (unsigned, whcar_t, enums, bit fields)
+	struct IsPromotion : impl::__IsPromotion<std::remove_cv_t<std::remove_reference_t<F>>, std::remove_cv_t<std::remove_reference_t<T>>> {};
 
 	template<class F, class T>
 	struct IsExactMatch : std::is_same<shl::decay_t<F>, shl::decay_t<T>> {};
 
 	template<class F, class T>
 	struct ConvRank {
-		// The standard says worst, but that's not working for now
-		//static constexpr size_t value = IsUserConvertable<F, T>::value ? 3 : IsStdConvertable<F, T>::value ? 2 : IsPromotion<F, T>::value ? 1 : IsExactMatch<F, T>::value ? 0 : -1;
-		static constexpr size_t value = IsUserConvertable<F, T>::value ? 3 : IsExactMatch<F, T>::value ? 0 : IsPromotion<F, T>::value ? 1 : IsStdConvertable<F, T>::value ? 2 : -1;
+		// Arguments that can't initialize the parameter at all (ie. a const lvalue to `T&`) rank below every conversion
+		static constexpr size_t value = !std::is_convertible<F, T>::value ? -1 : IsUserConvertable<T, F>::value ? 3 : IsExactMatch<F, T>::value ? 0 : IsPromotion<F, T>::value ? 1 : IsStdConvertable<T, F>::value ? 2 : -1;
+	};
+
+	// Test if Arg -> T1 converts to a more derived base class than Arg -> T0 (D& -> B& is better than D& -> A& if B derives from A)
+	template<class T0, class T1, class Arg>
+	struct IsCloserBase {
+		private:
+			template<class T>
+			using class_of = std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<T>>>;
+
+		public:
+			static constexpr bool value = std::is_class<class_of<T1>>::value && !std::is_same<class_of<T0>, class_of<T1>>::value
+				&& std::is_base_of<class_of<T0>, class_of<T1>>::value && std::is_base_of<class_of<T1>, class_of<Arg>>::value;
 	};
 
 	template<class F0_Param, class F1_Param, class Arg>
-	struct IsBetterArg : bool_t<less<ConvRank<Arg, F1_Param>, ConvRank<Arg, F0_Param>>()> {};
+	struct IsBetterArg : bool_t<less<ConvRank<Arg, F1_Param>, ConvRank<Arg, F0_Param>>()
+		|| (ConvRank<Arg, F0_Param>::value == ConvRank<Arg, F1_Param>::value && IsCloserBase<F0_Param, F1_Param, Arg>::value)> {};
 
 	template<class F0_Param, class F1_Param, class Arg>
-	struct IsEqArg : bool_t<ConvRank<Arg, F0_Param>::value == ConvRank<Arg, F1_Param>::value> {};
+	struct IsEqArg : bool_t<ConvRank<Arg, F0_Param>::value == ConvRank<Arg, F1_Param>::value
+		&& !IsCloserBase<F0_Param, F1_Param, Arg>::value && !IsCloserBase<F1_Param, F0_Param, Arg>::value> {};
 
 	template<class F0_Param, class F1_Param, class Arg>
 	struct IsBetterOrEqArg
@@ -1,9 +1,21 @@
+#include <any>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "ADT.h"
+#include "ADTRecursive.h"
+#include "ADTVector.h"
+#include "AsyncMatch.h"
+#include "Mailbox.h"
 #include "MatchResolver.h"
+#include "ParallelMatch.h"
 //#include "Option.h"
 
 // TODO: Ensure ConvRank is implemented accurately
@@ -13,20 +25,64 @@
 // TODO: Fix intellisense
 	// The intellisense errors are just because I've deleted the copy/move constructors
 
-// TODO: Add the ability to "return" (get) a value from match
-	// Add support for value cases (currently ignored)
 // TODO: Actually work on ADT syntax
 
 // TODO: Look into improving implementation ala (https://github.com/pfultz2/Fit)
 // TODO: Improve meta structs with template<auto> once support is added
-// TODO: Replace __IndexOf with constexpr once support is added (iterating over initalizer_list)
 // TODO: Replace some things with fold expressions once support is added
-// TODO: Rework match to work for `std::variant` and `std::any` once support is added
 // TODO: Find a way to warn about missing '||' in MatchResolver			<- Not possible AFAIK (must be done as a "standalone")
 // TODO: Find a way to remove the need for '||' syntax					<- Not possible AFAIK
 
-// TODO: Figure out how to turn this into a benchmarking practice
-// Turn this into a practice on benchmarking (and explore the improvements of various c++ facilities, ie. && vs const &)
+// Benchmarks live in bench/ (compile_bench.py for resolution cost, runtime_bench.cpp for dispatch cost)
+
+// Closed hierarchy for RTTI-free matching on `Shape&`
+struct Shape {
+	const size_t kind;
+
+	protected:
+		Shape(size_t kind) : kind{ kind } {}
+};
+
+struct Circle;
+struct Square;
+
+namespace shl {
+	template<> struct hierarchy_of<Shape> : closed_hierarchy<Shape, Circle, Square> {
+		static size_t tag(const Shape& s) { return s.kind; }
+	};
+}
+
+struct Circle : Shape { Circle() : Shape{ shl::hierarchy_of<Shape>::tag_of<Circle>() } {} };
+struct Square : Shape { Square() : Shape{ shl::hierarchy_of<Shape>::tag_of<Square>() } {} };
+
+// Case that counts how often it gets copied and moved while its Matcher is built
+struct Counted {
+	static inline int copies = 0, moves = 0;
+
+	Counted() = default;
+	Counted(const Counted&) { ++copies; }
+	Counted(Counted&&) { ++moves; }
+
+	void operator()(int) const { std::cout << copies << " copies, " << moves << " move\n"; }
+};
+
+// Recursive expression type, with its nodes in an arena
+struct Expr;
+struct Num { int value; };
+struct Add { shl::rec<Expr> lhs, rhs; };
+struct Neg { shl::rec<Expr> arg; };
+struct Expr : shl::adt<Num, Add, Neg> { using adt::adt; };
+
+// Matchers are built and run at compile time when every case is constexpr
+constexpr auto parity = shl::match()
+	| shl::val<0>([] { return 0; })
+	| shl::str("zero")([] { return 0; })
+	| [](int x) { return x % 2 ? 1 : 2; }
+	|| [](std::string_view s) { return int(s.size()); };
+
+static_assert(parity(0) == 0 && parity(3) == 1 && parity(4) == 2);
+static_assert(parity(std::string_view{ "zero" }) == 0 && parity(std::string_view{ "three" }) == 5);
+static_assert((shl::match(std::make_tuple(1, 2)) | [](int a, int b) { return a + b; } || [] { return 0; }) == 3);
 
 int main() {
 	auto tupl = std::make_tuple(3, std::string{ "Hello" }.c_str());
@@ -79,11 +135,278 @@ int main() {
 		| [](int) { std::cout << "An int\n"; }
 		|| [](long) { std::cout << "A long\n"; };
 
+	std::cout << "An int            - ";
+	shl::match<shl::TournamentResolver>(short{ 3 })
+		| [](long) { std::cout << "A long\n"; }
+		| [](int) { std::cout << "An int\n"; }
+		|| [](double) { std::cout << "A double\n"; };
+
+	std::cout << "An int            - ";
+	shl::match(static_cast<unsigned char>(3))
+		| [](long) { std::cout << "A long\n"; }
+		|| [](int) { std::cout << "An int\n"; };
+
+	std::cout << "A bool            - ";
+	shl::match(c_str)
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| [](bool) { std::cout << "A bool\n"; };
+
+	std::cout << "A string_view     - ";
+	shl::match<shl::AllocAwareResolver>(c_str)
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| [](std::string_view) { std::cout << "A string_view\n"; };
+
+	auto var = std::variant<int, std::string, std::vector<int>>{ str };
+
+	std::cout << "A string          - ";
+	shl::match(var)
+		| [](int) { std::cout << "An int\n"; }
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| []() { std::cout << "Base case\n"; };
+
+	var = std::vector<int>{ 3 };
+	std::cout << "Base case         - ";
+	shl::match(var)
+		| [](int) { std::cout << "An int\n"; }
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| []() { std::cout << "Base case\n"; };
+
+	std::cout << "The variant       - ";
+	shl::match(var)
+		| [](int) { std::cout << "An int\n"; }
+		|| [&var](const decltype(var)& v) { std::cout << (&v == &var ? "The variant\n" : "A copy\n"); };
+
+	auto any = std::any{ str };
+
+	std::cout << "A string          - ";
+	shl::match(any)
+		| [](int) { std::cout << "An int\n"; }
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| []() { std::cout << "Base case\n"; };
+
+	auto square = Square{};
+	Shape& shape = square;
+
+	std::cout << "A square          - ";
+	shl::match(shape)
+		| [](Shape&) { std::cout << "A shape\n"; }
+		| [](Circle&) { std::cout << "A circle\n"; }
+		|| [](Square&) { std::cout << "A square\n"; };
+
+	auto circle = Circle{};
+	Shape& other = circle;
+
+	std::cout << "Square hits circle - ";
+	shl::match(shape, other)
+		| [](Circle&, Circle&) { std::cout << "Circles touch\n"; }
+		| [](Square&, Circle&) { std::cout << "Square hits circle\n"; }
+		| [](Shape&, Shape&) { std::cout << "Shapes collide\n"; }
+		|| [](Circle&, Square&) { std::cout << "Circle hits square\n"; };
+
+	std::cout << "0 copies, 1 move  - ";
+	shl::match(3)
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| Counted{};
+
+	auto owned = std::make_unique<std::string>("A move-only case");
+
+	std::cout << "A move-only case  - ";
+	shl::match(3)
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| [p = std::move(owned)](int) { std::cout << *p << "\n"; };
+
+	auto point = std::make_pair(3, std::string{ "A pair" });
+
+	std::cout << "A pair            - ";
+	shl::match(point)
+		| [](int) { std::cout << "An int\n"; }
+		|| [](int, const std::string& s) { std::cout << s << "\n"; };
+
+	struct Person { std::string name; int age; } person{ "An aggregate", 3 };
+
+	std::cout << "An aggregate      - ";
+	shl::match(person)
+		| [](const std::string&) { std::cout << "A string\n"; }
+		|| [](const std::string& name, int) { std::cout << name << "\n"; };
+
+	// Aggregates whose fields can't be counted are only taken whole
+	struct Nine { int a, b, c, d, e, f, g, h, i; } nine{};
+	struct Pair { int xs[2]; } pair{};
+	struct Base { int x; };
+	struct Derived : Base { int y; } derived{};
+
+	std::cout << "Nine Pair Derived - ";
+	shl::match(nine) | [](int) { std::cout << "An int "; } || [](const Nine&) { std::cout << "Nine "; };
+	shl::match(pair) | [](int) { std::cout << "An int "; } || [](const Pair&) { std::cout << "Pair "; };
+	shl::match(derived) | [](int) { std::cout << "An int\n"; } || [](const Derived&) { std::cout << "Derived\n"; };
+
+	auto nested = std::make_tuple(3, std::make_tuple(std::string{ "A nested tuple" }, 3.3));
+
+	std::cout << "A nested tuple    - ";
+	shl::match(nested)
+		| [](int) { std::cout << "An int\n"; }
+		|| [](int, std::tuple<const std::string&, double> inner) { std::cout << std::get<0>(inner) << "\n"; };
+
+	std::cout << "A result          - ";
+	std::cout << (shl::match(3)
+		| [](const std::string& s) { return s; }
+		|| [](int) { return "A result"; }) << "\n";
+
+	auto describe = shl::match<std::string>()
+		| [](int) { return "An int"; }
+		|| "A value case";
+
+	std::cout << "A value case      - " << describe(std::string{ "Hello" }) << "\n";
+
+	auto values = std::vector<std::variant<int, std::string>>{ 1, std::string{ "A string" }, 2 };
+	auto print = shl::match()
+		| [](int i) { std::cout << i << " "; }
+		|| [](const std::string& s) { std::cout << s << " "; };
+
+	std::cout << "1 2 A string      - ";
+	print.match_all(values);
+	std::cout << "\n1 A string 2      - ";
+	shl::match_each(values, print, shl::in_order);
+	std::cout << "\n";
+
+	auto columns = shl::adt_vector<int, std::string>{};
+	columns.push_back(1);
+	columns.push_back(std::string{ "A string" });
+	columns.push_back(2);
+
+	std::cout << "1 2 A string      - ";
+	print.match_all(columns);
+	std::cout << "\n1 A string 2      - ";
+	print.match_all(columns, shl::in_order);
+	std::cout << "\n";
+
+	auto lengths = shl::match()
+		| [](int) { return size_t{ 1 }; }
+		|| [](const std::string& s) { return s.size(); };
+
+	std::cout << "10                - " << shl::par_match(values, lengths, size_t{ 0 }, std::plus<>{}) << "\n";
+
+	auto opcode = [](int op) {
+		return shl::match(op)
+			| shl::val<0>("push")
+			| shl::val<1, 2>("pop")
+			| shl::range<10, 19>("jump")
+			|| "unknown";
+	};
+
+	std::cout << "push jump unknown - " << opcode(0) << " " << opcode(12) << " " << opcode(7) << "\n";
+
+	auto method = [](std::string_view name) {
+		return shl::match(name)
+			| shl::str("GET")("read")
+			| shl::str("PUT")("write")
+			|| "unknown";
+	};
+
+	std::cout << "read write unknown - " << method("GET") << " " << method("PUT") << " " << method("BREW") << "\n";
+
+	auto validate = shl::match()
+		| shl::when([](int i) { return i < 0; }, shl::commutative)("negative")
+		| shl::when([](int i) { return i > 100; }, shl::commutative)("too big")
+		|| "valid";
+
+	std::cout << "negative valid    - " << validate(-1) << " " << validate(50) << "\n";
+
+	int found = 7;
+	auto lookup = [](shl::option<int*> slot) {
+		return shl::match(slot)
+			| [](int* p) { return *p; }
+			|| [](shl::none_t) { return -1; };
+	};
+
+	std::cout << "7 -1              - " << lookup(&found) << " " << lookup(shl::none) << "\n";
+	std::cout << "Pointer-sized     - " << (sizeof(shl::option<int*>) == sizeof(int*) ? "Pointer-sized" : "Bigger") << "\n";
+
+	auto maybe = std::vector<shl::adt<int, std::string, shl::none_t>>{ 1, std::string{ "A string" }, shl::none };
+	auto print_maybe = shl::match()
+		| [](int i) { std::cout << i << " "; }
+		| [](const std::string& s) { std::cout << s << " "; }
+		|| [](shl::none_t) { std::cout << "none"; };
+
+	std::cout << "1 A string none   - ";
+	shl::match_each(maybe, print_maybe, shl::in_order);
+	std::cout << "\n";
+
+	auto counted = shl::match<shl::DefaultResolver, shl::count_cases>()
+		| [](int) {}
+		|| [](const std::string&) {};
+
+	counted(1);
+	counted(2);
+
+	auto hits = counted.profile();
+	std::cout << "2 0               - " << hits[0].hits << " " << hits[1].hits << "\n";
+	//counted.report(std::cout);
+
 	// Throws a compiler error as int->short has the same weight as int->long in resolution
 	//std::cout << "An int            - ";
 	//shl::match<shl::impl::StrictResolver>(int{ 3 })
 	//	| [](long) { std::cout << "A long\n"; }
 	//	|| [](short) { std::cout << "An int\n"; };
 
+	// Throws a compiler error as the only case that takes a `const char*` builds a `std::string` for it
+	//shl::match<shl::NoAllocResolver>(c_str)
+	//	| [](const std::string&) { std::cout << "A string\n"; }
+	//	|| []() { std::cout << "Base case\n"; };
+
+	auto total = 0;
+	auto actor = shl::match()
+		| [&](int i) { total += i; }
+		|| [&](const std::string& s) { total += (int)s.size(); };
+
+	shl::mailbox<decltype(actor), int, std::string> inbox{ actor, 16 };
+	std::thread sender{ [&] {
+		for (int i = 0; i != 100; ++i) inbox.post(1);
+		inbox.post(std::string{ "A string" });
+		inbox.close();
+	} };
+
+	auto received = inbox.run();
+	sender.join();
+	std::cout << "101 108           - " << received << " " << total << "\n";
+
+	// Deep enough to overflow the stack of a recursive visitor
+	shl::arena nodes;
+	shl::rec<Expr> expr = nodes.make<Expr>(Num{ 1 });
+	for (int i = 0; i != 100000; ++i)
+		expr = i % 2 ? nodes.make<Expr>(Neg{ expr }) : nodes.make<Expr>(Add{ expr, nodes.make<Expr>(Num{ 2 }) });
+
+	auto eval = shl::match()
+		| [](const Num& n) { return n.value; }
+		| [](const Add&, int lhs, int rhs) { return lhs + rhs; }
+		|| [](const Neg&, int arg) { return -arg; };
+
+	std::cout << "1 100001          - " << shl::fold(expr, eval) << " " << (shl::fold(expr)
+		| [](const Num&) { return 1; }
+		| [](const Add&, int lhs, int rhs) { return 1 + std::max(lhs, rhs); }
+		|| [](const Neg&, int arg) { return 1 + arg; }) << "\n";
+
+#ifdef __cpp_impl_coroutine
+	using message = std::variant<int, std::string>;
+
+	auto messages = []() -> shl::message_stream<message> {
+		co_yield message{ 3 };
+		co_yield message{ std::string{ "ping" } };
+		co_yield message{ 4 };
+	};
+
+	auto handled = 0;
+	shl::sync_wait(shl::async_match(messages())
+		| [&](int i) -> shl::match_task<> { handled += i; co_return; }
+		|| [&](const std::string& s) -> shl::match_task<> { handled += (int)s.size(); co_return; });
+
+	std::cout << "11                - " << handled << "\n";
+
+	auto request = []() -> shl::match_task<message> { co_return message{ std::string{ "A string" } }; };
+	std::cout << "A string          - " << shl::sync_wait(shl::async_match(request())
+		| [](int) -> std::string_view { return "An int"; }
+		|| [](const std::string&) -> std::string_view { return "A string"; }) << "\n";
+#endif
+
 	std::cin.get();
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <functional>
+
 #include "function_traits.h"
 
 #define NOT_FOUND -1
 
 // TODO: Remove when std::apply is implemented
+#ifndef __cpp_lib_apply
 namespace std {
 	template<class F, class T, std::size_t... I>
 	constexpr auto apply_impl(F&& f, T&& t, std::index_sequence<I...>) {
@@ -29,6 +32,7 @@ namespace std {
 	}
 	*/
 }
+#endif
 
 namespace shl {
 	namespace impl {
@@ -50,13 +54,25 @@ namespace shl {
 		struct takes_args<true, Fn, argpack<Args...>> {
 			private:
 				using arg_types = typename function_traits<Fn>::arg_types;
-				using decom_type = argpack<shl::decay_t<Args>...>;
+				using decom_type = argpack<Args&&...>;
 				using tuple_type = argpack<decom_type>;
 
 			public:
 				static constexpr bool value = callable_with<arg_types, decom_type>::value || callable_with<arg_types, tuple_type>::value;
 		};
 
+		// Decomposed elements of a tuple reference keep the tuple's value category (so `T&` parameters can bind to them)
+		template<class Fn, class... Args>
+		struct takes_args<true, Fn, argpack<Args...>&>
+			: bool_t<callable_with<typename function_traits<Fn>::arg_types, argpack<Args&...>>::value || callable_with<typename function_traits<Fn>::arg_types, argpack<argpack<Args...>&>>::value> {};
+
+		template<class Fn, class... Args>
+		struct takes_args<true, Fn, const argpack<Args...>&>
+			: bool_t<callable_with<typename function_traits<Fn>::arg_types, argpack<const Args&...>>::value || callable_with<typename function_traits<Fn>::arg_types, argpack<const argpack<Args...>&>>::value> {};
+
+		template<class Fn, class... Args>
+		struct takes_args<true, Fn, argpack<Args...>&&> : takes_args<true, Fn, argpack<Args...>> {};
+
 
 		/*
 		 * Metastructs to determine the relative ranking of two functions to an argument list
@@ -68,21 +84,25 @@ namespace shl {
 
 		// A function is a better overload if every parameter is an equal or better match to the arguments than the previous best
 		// and there is at least one parameter that is a better match to its argument than the equivalent parameter in the previous best
+			// A viable function always beats one that isn't (with several arguments, the unviable one can still have better parameters)
 		template<class... F0_Params, class... F1_Params, class... Args>
 		struct __BetterMatchImpl<true, argpack<F0_Params...>, argpack<F1_Params...>, Args...>
-			: bool_t<all<std::true_type, IsBetterOrEqArg<F0_Params, F1_Params, Args>...>::value									// IsBetterOrEqArg < std::true_type for all params of f1
-			&& one<std::true_type, IsBetterArg<F0_Params, F1_Params, Args>...>::value> {};					// IsBetterArg < std::true_type for 1+ params of f1
+			: bool_t<(!callable_with<argpack<F0_Params...>, argpack<Args...>>::value && callable_with<argpack<F1_Params...>, argpack<Args...>>::value)
+			|| (all<std::true_type, IsBetterOrEqArg<F0_Params, F1_Params, Args>...>::value									// IsBetterOrEqArg < std::true_type for all params of f1
+			&& one<std::true_type, IsBetterArg<F0_Params, F1_Params, Args>...>::value)> {};					// IsBetterArg < std::true_type for 1+ params of f1
 
 
 		/*
 		 * Add size mismatch protection to __BetterMatch
+		 *	A function whose arity matches the argument count is always better than one that doesn't
 		 */
 		template<class F0_Params, class F1_Params, class... Args>
 		class __SizeFilter : public std::false_type {};
 
 		template<class... F0_Params, class... F1_Params, class... Args>
 		struct __SizeFilter<argpack<F0_Params...>, argpack<F1_Params...>, Args...>
-			: __BetterMatchImpl<sizeof...(F0_Params) == sizeof...(F1_Params) && sizeof...(F1_Params) == sizeof...(Args), argpack<F0_Params...>, argpack<F1_Params...>, Args...> {};
+			: bool_t<__BetterMatchImpl<sizeof...(F0_Params) == sizeof...(F1_Params) && sizeof...(F1_Params) == sizeof...(Args), argpack<F0_Params...>, argpack<F1_Params...>, Args...>::value
+			|| (sizeof...(F0_Params) != sizeof...(Args) && sizeof...(F1_Params) == sizeof...(Args))> {};
 
 
 		/*
@@ -187,7 +207,7 @@ namespace shl {
 		struct __BaseCase {
 			static constexpr bool value = function_traits<Fn>::arity == 0;
 		};
-		template<class Fn> struct __BaseCase<false, Fn> : std::false_type {};
+		template<class Fn> struct __BaseCase<false, Fn> : std::true_type {};						// Values are constants for anything the other cases don't take
 
 
 		// Impl class to enable handling of non-function types 
@@ -216,6 +236,7 @@ namespace shl {
 
 	/*
 	 * Helper structs to reverse the ordering of a parameter pack
+	 *	Every type is tagged with its position and picked back out by overload resolution (avoids recursing on the pack)
 	 */
 	template<class T, class A>
 	struct tuple_add;
@@ -225,13 +246,30 @@ namespace shl {
 		using type = std::tuple<Ts..., As>;
 	};
 
-	template<class T, class... Ts>
-	struct reverse {
-		using type = typename tuple_add<typename reverse<Ts...>::type, T>::type;
-	};
+	namespace impl {
+		template<size_t I, class T>
+		struct __Indexed {
+			using type = T;
+		};
 
-	template<class T>
-	struct reverse<T> {
-		using type = std::tuple<T>;
-	};
+		template<class Is, class... Ts>
+		struct __IndexedPack;
+
+		template<size_t... Is, class... Ts>
+		struct __IndexedPack<std::index_sequence<Is...>, Ts...> : __Indexed<Is, Ts>... {};
+
+		template<size_t I, class T>
+		__Indexed<I, T> __TypeAt(const __Indexed<I, T>&);
+
+		template<class Is, class... Ts>
+		struct __Reverse;
+
+		template<size_t... Is, class... Ts>
+		struct __Reverse<std::index_sequence<Is...>, Ts...> {
+			using type = std::tuple<typename decltype(__TypeAt<sizeof...(Ts) - Is - 1>(std::declval<__IndexedPack<std::index_sequence<Is...>, Ts...>>()))::type...>;
+		};
+	}
+
+	template<class T, class... Ts>
+	struct reverse : impl::__Reverse<std::index_sequence_for<T, Ts...>, T, Ts...> {};
 }
\ No newline at end of file